@@ -287,6 +287,125 @@ namespace CEC
      * @return The new audio status.
      */
     virtual uint8_t MuteAudio(void) = 0;
+
+    /*!
+     * @brief Transmit a frame on the CEC line without waiting for the result.
+     * @param data The frame to send.
+     * @param callback Called with the result of the transmission from the thread that calls the callbacks that are
+     *                 set with EnableCallbacks(), also when those aren't set. May be NULL.
+     * @param param Passed to the callback.
+     * @return A ticket that is passed to the callback, or 0 when the frame could not be queued.
+     */
+    virtual uint32_t TransmitAsync(const cec_command &data, CBCecTransmitDone callback, void *param = NULL) = 0;
+
+    /*!
+     * @brief Get the queue depth and wait time statistics of a transmit class.
+     * @param transmitClass The class to get the statistics for.
+     * @param stats The statistics.
+     * @return True when the statistics were copied, false otherwise.
+     */
+    virtual bool GetTransmitStats(cec_transmit_class transmitClass, cec_transmit_class_stats *stats) = 0;
+
+    /*!
+     * @brief Poll all logical addresses that aren't handled by libCEC in one pass and update the status of the devices.
+     * @param result The devices that were polled, the devices that are present and the time the scan took.
+     * @param bPrefetch True to request the physical address and vendor ID of present devices for which they are not known yet.
+     * @return True when all polls were sent, false otherwise.
+     */
+    virtual bool ScanBus(cec_bus_scan_result *result, bool bPrefetch = true) = 0;
+
+    /*!
+     * @brief Get the cached CEC version of the device with the given logical address, without waiting for the bus.
+     *        When the version isn't known or expired, it is requested in the background.
+     * @param iAddress The device to get the CEC version for.
+     * @param iAgeMs The time in ms since the version was received, or -1 when it isn't known. May be NULL.
+     * @return The cached version or CEC_VERSION_UNKNOWN when it isn't known.
+     */
+    virtual cec_version GetCachedDeviceCecVersion(cec_logical_address iAddress, int64_t *iAgeMs = NULL) = 0;
+
+    /*!
+     * @brief Get the cached menu language of the device with the given logical address, without waiting for the bus.
+     *        When the language isn't known or expired, it is requested in the background.
+     * @param iAddress The device to get the menu language for.
+     * @param language The cached menu language.
+     * @param iAgeMs The time in ms since the language was received, or -1 when it isn't known. May be NULL.
+     * @return True when the language is known, false otherwise.
+     */
+    virtual bool GetCachedDeviceMenuLanguage(cec_logical_address iAddress, cec_menu_language *language, int64_t *iAgeMs = NULL) = 0;
+
+    /*!
+     * @brief Get the cached vendor ID of the device with the given logical address, without waiting for the bus.
+     *        When the vendor ID isn't known or expired, it is requested in the background.
+     * @param iAddress The device to get the vendor id for.
+     * @param iAgeMs The time in ms since the vendor ID was received, or -1 when it isn't known. May be NULL.
+     * @return The cached vendor ID or 0 when it isn't known.
+     */
+    virtual uint64_t GetCachedDeviceVendorId(cec_logical_address iAddress, int64_t *iAgeMs = NULL) = 0;
+
+    /*!
+     * @brief Get the cached power status of the device with the given logical address, without waiting for the bus.
+     *        When the power status isn't known or expired, it is requested in the background.
+     * @param iAddress The device to get the power status for.
+     * @param iAgeMs The time in ms since the power status was received, or -1 when it isn't known. May be NULL.
+     * @return The cached power status or CEC_POWER_STATUS_UNKNOWN when it isn't known.
+     */
+    virtual cec_power_status GetCachedDevicePowerStatus(cec_logical_address iAddress, int64_t *iAgeMs = NULL) = 0;
+
+    /*!
+     * @brief Store the bus configuration in a cache file when the connection is closed, and use it the next time a
+     *        connection to the same adapter is opened, so the logical and physical address and the state of the other
+     *        devices don't have to be detected again. The cached values are verified in the background.
+     *        Call this before Open().
+     * @param strDirectory The directory to store the cache files in, or NULL to disable the cache.
+     * @return True when the cache is enabled, false otherwise.
+     */
+    virtual bool EnableDeviceCache(const char *strDirectory) = 0;
+
+    /*!
+     * @brief Have log messages, keypresses, commands and state changes pushed to the client instead of polling for
+     *        them. The callbacks are called from a separate thread, in the order in which the events were added, so a
+     *        slow callback doesn't hold up the communication with the adapter. Events of a type without a callback are
+     *        still kept in their buffer for the GetNext methods. Don't call CECDestroy() from within a callback.
+     * @param callbacks The callbacks to use. They are copied, so the struct doesn't have to remain valid. NULL to
+     *        disable all callbacks. Events that are still waiting to be passed when the callbacks change are dropped.
+     * @param param A parameter that is passed to each callback.
+     * @return True when the callbacks were set, false otherwise.
+     */
+    virtual bool EnableCallbacks(const cec_callbacks *callbacks, void *param = NULL) = 0;
+
+    /*!
+     * @brief Get a descriptor that can be added to the poll(), select() or epoll set of the client. It is readable
+     *        for as long as there are log messages, keypresses or commands in their buffer, so the client only has
+     *        to wake up when there is something to do. Don't read from or close it, but drain the buffers with the
+     *        GetNext methods instead. Events that are passed to a callback don't make it readable.
+     * @return The descriptor, or -1 when it isn't supported on this platform.
+     */
+    virtual int GetEventFd(void) = 0;
+
+    /*!
+     * @name Batch methods
+     * @brief Get up to iMax entries from a buffer at once, instead of calling the GetNext method for each of them.
+     * @return The number of entries that were copied.
+     */
+    //@{
+    virtual uint32_t GetNextLogMessages(cec_log_message *messages, uint32_t iMax) = 0;
+    virtual uint32_t GetNextKeypresses(cec_keypress *keys, uint32_t iMax) = 0;
+    virtual uint32_t GetNextCommands(cec_command *commands, uint32_t iMax) = 0;
+    //@}
+
+    /*!
+     * @brief Only add log messages of these levels. Messages of other levels aren't even formatted, so a client that
+     *        ignores them should disable them here. All levels are enabled by default.
+     * @param iLogLevel A mask of cec_log_level values, e.g. CEC_LOG_ERROR | CEC_LOG_WARNING.
+     */
+    virtual void SetLogLevel(int iLogLevel) = 0;
+
+    /*!
+     * @brief Append the name of the opcode to CEC_LOG_TRAFFIC messages, e.g. "<< 10:8f (give device power status)".
+     *        Traffic is stored as raw bytes and only formatted when it's read, so this has no cost on the bus.
+     * @param bEnable True to add the names, false to only show the bytes (default).
+     */
+    virtual void EnableOpcodeNames(bool bEnable) = 0;
   };
 };
 
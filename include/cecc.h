@@ -139,6 +139,18 @@ extern DECLSPEC int cec_transmit(const CEC::cec_command *data);
 extern DECLSPEC int cec_transmit(const cec_command *data);
 #endif
 
+#ifdef __cplusplus
+extern DECLSPEC uint32_t cec_transmit_async(const CEC::cec_command *data, CEC::CBCecTransmitDone callback, void *param);
+#else
+extern DECLSPEC uint32_t cec_transmit_async(const cec_command *data, CBCecTransmitDone callback, void *param);
+#endif
+
+#ifdef __cplusplus
+extern DECLSPEC int cec_get_transmit_stats(CEC::cec_transmit_class transmitClass, CEC::cec_transmit_class_stats *stats);
+#else
+extern DECLSPEC int cec_get_transmit_stats(cec_transmit_class transmitClass, cec_transmit_class_stats *stats);
+#endif
+
 #ifdef __cplusplus
 extern DECLSPEC int cec_set_logical_address(CEC::cec_logical_address iLogicalAddress);
 #else
@@ -179,6 +191,30 @@ extern DECLSPEC CEC::cec_power_status cec_get_device_power_status(CEC::cec_logic
 extern DECLSPEC cec_power_status cec_get_device_power_status(cec_logical_address iLogicalAddress);
 #endif
 
+#ifdef __cplusplus
+extern DECLSPEC CEC::cec_version cec_get_cached_device_cec_version(CEC::cec_logical_address iLogicalAddress, int64_t *iAgeMs);
+#else
+extern DECLSPEC cec_version cec_get_cached_device_cec_version(cec_logical_address iLogicalAddress, int64_t *iAgeMs);
+#endif
+
+#ifdef __cplusplus
+extern DECLSPEC int cec_get_cached_device_menu_language(CEC::cec_logical_address iLogicalAddress, CEC::cec_menu_language *language, int64_t *iAgeMs);
+#else
+extern DECLSPEC int cec_get_cached_device_menu_language(cec_logical_address iLogicalAddress, cec_menu_language *language, int64_t *iAgeMs);
+#endif
+
+#ifdef __cplusplus
+extern DECLSPEC uint64_t cec_get_cached_device_vendor_id(CEC::cec_logical_address iLogicalAddress, int64_t *iAgeMs);
+#else
+extern DECLSPEC uint64_t cec_get_cached_device_vendor_id(cec_logical_address iLogicalAddress, int64_t *iAgeMs);
+#endif
+
+#ifdef __cplusplus
+extern DECLSPEC CEC::cec_power_status cec_get_cached_device_power_status(CEC::cec_logical_address iLogicalAddress, int64_t *iAgeMs);
+#else
+extern DECLSPEC cec_power_status cec_get_cached_device_power_status(cec_logical_address iLogicalAddress, int64_t *iAgeMs);
+#endif
+
 #ifdef __cplusplus
 extern DECLSPEC int cec_poll_device(CEC::cec_logical_address iLogicalAddress);
 #else
@@ -191,6 +227,12 @@ extern DECLSPEC CEC::cec_logical_addresses cec_get_active_devices(void);
 extern DECLSPEC cec_logical_addresses cec_get_active_devices(void);
 #endif
 
+#ifdef __cplusplus
+extern DECLSPEC int cec_scan_bus(CEC::cec_bus_scan_result *result, int bPrefetch);
+#else
+extern DECLSPEC int cec_scan_bus(cec_bus_scan_result *result, int bPrefetch);
+#endif
+
 #ifdef __cplusplus
 extern DECLSPEC int cec_is_active_device(CEC::cec_logical_address iAddress);
 #else
@@ -211,6 +253,38 @@ extern DECLSPEC int cec_volume_down(void);
 
 extern DECLSPEC int cec_mute_audio(void);
 
+extern DECLSPEC int cec_enable_device_cache(const char *strDirectory);
+
+#ifdef __cplusplus
+extern DECLSPEC int cec_enable_callbacks(const CEC::cec_callbacks *callbacks, void *param);
+#else
+extern DECLSPEC int cec_enable_callbacks(const cec_callbacks *callbacks, void *param);
+#endif
+
+extern DECLSPEC int cec_get_event_fd(void);
+
+#ifdef __cplusplus
+extern DECLSPEC int cec_get_next_log_messages(CEC::cec_log_message *messages, uint32_t iMax);
+#else
+extern DECLSPEC int cec_get_next_log_messages(cec_log_message *messages, uint32_t iMax);
+#endif
+
+#ifdef __cplusplus
+extern DECLSPEC int cec_get_next_keypresses(CEC::cec_keypress *keys, uint32_t iMax);
+#else
+extern DECLSPEC int cec_get_next_keypresses(cec_keypress *keys, uint32_t iMax);
+#endif
+
+#ifdef __cplusplus
+extern DECLSPEC int cec_get_next_commands(CEC::cec_command *commands, uint32_t iMax);
+#else
+extern DECLSPEC int cec_get_next_commands(cec_command *commands, uint32_t iMax);
+#endif
+
+extern DECLSPEC int cec_set_log_level(int iLogLevel);
+
+extern DECLSPEC int cec_enable_opcode_names(int bEnable);
+
 #ifdef __cplusplus
 };
 #endif
@@ -64,9 +64,9 @@ namespace CEC {
 #define ESCOFFSET                    3
 #define CEC_BUTTON_TIMEOUT           500
 
-#define CEC_MIN_LIB_VERSION          1
+#define CEC_MIN_LIB_VERSION          2
 #define CEC_LIB_VERSION_MAJOR        1
-#define CEC_LIB_VERSION_MINOR        2
+#define CEC_LIB_VERSION_MINOR        3
 
 typedef enum cec_abort_reason
 {
@@ -626,6 +626,46 @@ typedef struct cec_adapter
   char comm[1024];
 } cec_adapter;
 
+typedef enum cec_transmit_status
+{
+  CEC_TRANSMIT_STATUS_PENDING = 0,
+  CEC_TRANSMIT_STATUS_ACKED,
+  CEC_TRANSMIT_STATUS_NACKED,
+  CEC_TRANSMIT_STATUS_LINE_ERROR,
+  CEC_TRANSMIT_STATUS_TIMEOUT,
+  CEC_TRANSMIT_STATUS_ERROR
+} cec_transmit_status;
+
+/*!
+ * @brief Called when a frame that was sent with TransmitAsync() has been acked, was not acked or failed.
+ * @param param The parameter that was passed to TransmitAsync().
+ * @param iTicket The ticket that was returned by TransmitAsync().
+ * @param status The result of the transmission.
+ */
+typedef void (*CBCecTransmitDone)(void *param, uint32_t iTicket, cec_transmit_status status);
+
+/*!
+ * @brief The scheduling class of a frame. Queued frames of a class are sent before the frames of the
+ *        classes below it, unless those have been waiting for too long.
+ */
+typedef enum cec_transmit_class
+{
+  CEC_TRANSMIT_CLASS_INTERACTIVE = 0, /*!< keypresses, volume changes and other user initiated actions */
+  CEC_TRANSMIT_CLASS_RESPONSE,        /*!< replies to requests from other devices */
+  CEC_TRANSMIT_CLASS_BACKGROUND,      /*!< polls, discovery and other requests */
+  CEC_TRANSMIT_CLASS_MAX              = CEC_TRANSMIT_CLASS_BACKGROUND
+} cec_transmit_class;
+
+typedef struct cec_transmit_class_stats
+{
+  uint32_t iQueued;        /*!< the number of frames that are currently queued */
+  uint32_t iMaxQueued;     /*!< the highest number of frames that were queued at the same time */
+  uint64_t iTransmitted;   /*!< the number of frames that were sent to the adapter */
+  uint64_t iAged;          /*!< the number of frames that were sent before frames of a higher class because they waited for too long */
+  uint64_t iTotalWaitMs;   /*!< the total time that sent frames spent in the queue */
+  uint32_t iMaxWaitMs;     /*!< the longest time that a sent frame spent in the queue */
+} cec_transmit_class_stats;
+
 typedef struct cec_datapacket
 {
   uint8_t data[100];
@@ -849,6 +889,64 @@ typedef struct cec_logical_addresses
 #endif
 } cec_logical_addresses;
 
+typedef struct cec_bus_scan_result
+{
+  cec_logical_addresses scanned;     /*!< the addresses that were polled */
+  cec_logical_addresses present;     /*!< the addresses that acked the poll */
+  uint32_t              iDurationMs; /*!< the time in ms it took to poll all addresses */
+} cec_bus_scan_result;
+
+typedef enum cec_state_change_type
+{
+  CEC_STATE_CHANGE_POWER_STATUS = 0, /*!< the power status of a device changed */
+  CEC_STATE_CHANGE_ACTIVE_SOURCE     /*!< a device became the active source, or is no longer the active source */
+} cec_state_change_type;
+
+typedef struct cec_state_change
+{
+  cec_state_change_type type;
+  cec_logical_address   address;       /*!< the device whose state changed */
+  cec_power_status      powerStatus;   /*!< the new power status of the device */
+  uint8_t               bActiveSource; /*!< 1 when the device is the active source, 0 otherwise */
+} cec_state_change;
+
+/*!
+ * @name Callbacks
+ * @brief Called from the callback thread of libcec. The payload is only valid until the callback returns.
+ *        C++ clients receive it by reference and C clients by pointer.
+ */
+//@{
+#ifdef __cplusplus
+typedef void (*CBCecLogMessage)(void *param, const cec_log_message &message);
+typedef void (*CBCecKeyPress)(void *param, const cec_keypress &key);
+typedef void (*CBCecCommand)(void *param, const cec_command &command);
+typedef void (*CBCecStateChange)(void *param, const cec_state_change &change);
+#else
+typedef void (*CBCecLogMessage)(void *param, const cec_log_message *message);
+typedef void (*CBCecKeyPress)(void *param, const cec_keypress *key);
+typedef void (*CBCecCommand)(void *param, const cec_command *command);
+typedef void (*CBCecStateChange)(void *param, const cec_state_change *change);
+#endif
+//@}
+
+typedef struct cec_callbacks
+{
+  CBCecLogMessage  CBLogMessage;  /*!< a log message was added. NULL to keep them in the log buffer */
+  CBCecKeyPress    CBKeyPress;    /*!< a key was pressed or released. NULL to keep them in the key buffer */
+  CBCecCommand     CBCommand;     /*!< a command was forwarded to the client. NULL to keep them in the command buffer */
+  CBCecStateChange CBStateChange; /*!< the power status or active source of a device changed. NULL to ignore these */
+
+#ifdef __cplusplus
+  void Clear(void)
+  {
+    CBLogMessage  = NULL;
+    CBKeyPress    = NULL;
+    CBCommand     = NULL;
+    CBStateChange = NULL;
+  }
+#endif
+} cec_callbacks;
+
 #ifdef __cplusplus
 };
 };
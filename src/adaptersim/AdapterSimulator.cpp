@@ -0,0 +1,599 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "AdapterSimulator.h"
+#include <string.h>
+#include "../lib/platform/transport.h"
+#include "../lib/platform/timeutils.h"
+
+using namespace std;
+using namespace CEC;
+
+#define MSGSTART                    0xFF
+#define MSGEND                      0xFE
+#define MSGESC                      0xFD
+#define ESCOFFSET                   3
+
+/* timing of a real CEC bus, in milliseconds */
+#define CEC_SIM_START_BIT_TIME      4.5
+#define CEC_SIM_BYTE_TIME           24.0
+#define CEC_SIM_RESPONSE_TIME       5.0
+
+static cec_device_type GetDeviceType(cec_logical_address address)
+{
+  switch (address)
+  {
+  case CECDEVICE_TV:
+    return CEC_DEVICE_TYPE_TV;
+  case CECDEVICE_RECORDINGDEVICE1:
+  case CECDEVICE_RECORDINGDEVICE2:
+  case CECDEVICE_RECORDINGDEVICE3:
+    return CEC_DEVICE_TYPE_RECORDING_DEVICE;
+  case CECDEVICE_TUNER1:
+  case CECDEVICE_TUNER2:
+  case CECDEVICE_TUNER3:
+  case CECDEVICE_TUNER4:
+    return CEC_DEVICE_TYPE_TUNER;
+  case CECDEVICE_PLAYBACKDEVICE1:
+  case CECDEVICE_PLAYBACKDEVICE2:
+  case CECDEVICE_PLAYBACKDEVICE3:
+    return CEC_DEVICE_TYPE_PLAYBACK_DEVICE;
+  case CECDEVICE_AUDIOSYSTEM:
+    return CEC_DEVICE_TYPE_AUDIO_SYSTEM;
+  default:
+    return CEC_DEVICE_TYPE_RESERVED;
+  }
+}
+
+/* replies and notifications are never answered with a feature abort */
+static bool IsReplyOrNotification(cec_opcode opcode)
+{
+  switch (opcode)
+  {
+  case CEC_OPCODE_FEATURE_ABORT:
+  case CEC_OPCODE_ACTIVE_SOURCE:
+  case CEC_OPCODE_CEC_VERSION:
+  case CEC_OPCODE_DECK_STATUS:
+  case CEC_OPCODE_DEVICE_VENDOR_ID:
+  case CEC_OPCODE_MENU_STATUS:
+  case CEC_OPCODE_REPORT_AUDIO_STATUS:
+  case CEC_OPCODE_REPORT_PHYSICAL_ADDRESS:
+  case CEC_OPCODE_REPORT_POWER_STATUS:
+  case CEC_OPCODE_ROUTING_CHANGE:
+  case CEC_OPCODE_ROUTING_INFORMATION:
+  case CEC_OPCODE_SET_MENU_LANGUAGE:
+  case CEC_OPCODE_SET_OSD_NAME:
+  case CEC_OPCODE_SET_STREAM_PATH:
+  case CEC_OPCODE_SET_SYSTEM_AUDIO_MODE:
+  case CEC_OPCODE_SYSTEM_AUDIO_MODE_STATUS:
+  case CEC_OPCODE_USER_CONTROL_PRESSED:
+  case CEC_OPCODE_USER_CONTROL_RELEASE:
+  case CEC_OPCODE_VENDOR_COMMAND:
+  case CEC_OPCODE_VENDOR_COMMAND_WITH_ID:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static void FormatFeatureAbort(cec_command &command, cec_logical_address initiator, cec_logical_address destination, cec_opcode opcode)
+{
+  cec_command::Format(command, initiator, destination, CEC_OPCODE_FEATURE_ABORT);
+  command.parameters.PushBack((uint8_t) opcode);
+  command.parameters.PushBack((uint8_t) CEC_ABORT_REASON_UNRECOGNIZED_OPCODE);
+}
+
+CAdapterSimulator::CAdapterSimulator(ITransport *transport) :
+    m_transport(transport),
+    m_iTiming(100),
+    m_iNackRate(0),
+    m_iLineErrorRate(0),
+    m_iRandom(1),
+    m_iKeypressInterval(0),
+    m_iNextKeypress(0),
+    m_iBusFree(0),
+    m_iAckMask(0),
+    m_bAckPolarityHigh(false),
+    m_activeSource(CECDEVICE_UNKNOWN),
+    m_bGotStart(false),
+    m_bNextIsEscaped(false)
+{
+  memset(&m_stats, 0, sizeof(m_stats));
+  m_currentMessage.Clear();
+  m_currentFrame.Clear();
+}
+
+CAdapterSimulator::~CAdapterSimulator(void)
+{
+  Stop();
+  delete m_transport;
+}
+
+void CAdapterSimulator::AddDevice(const cec_sim_device &device)
+{
+  m_devices.push_back(device);
+}
+
+void CAdapterSimulator::AddDefaultDevices(void)
+{
+  cec_sim_device tv;
+  tv.address          = CECDEVICE_TV;
+  tv.iPhysicalAddress = 0x0000;
+  tv.iVendorId        = CEC_VENDOR_SAMSUNG;
+  tv.powerStatus      = CEC_POWER_STATUS_ON;
+  tv.cecVersion       = CEC_VERSION_1_3A;
+  tv.strOSDName       = "TV";
+  tv.strMenuLanguage  = "eng";
+  AddDevice(tv);
+
+  cec_sim_device avr;
+  avr.address          = CECDEVICE_AUDIOSYSTEM;
+  avr.iPhysicalAddress = 0x1000;
+  avr.iVendorId        = CEC_VENDOR_ONKYO;
+  avr.powerStatus      = CEC_POWER_STATUS_ON;
+  avr.cecVersion       = CEC_VERSION_1_3A;
+  avr.strOSDName       = "AVR";
+  AddDevice(avr);
+
+  cec_sim_device player;
+  player.address          = CECDEVICE_PLAYBACKDEVICE2;
+  player.iPhysicalAddress = 0x2000;
+  player.iVendorId        = CEC_VENDOR_PIONEER;
+  player.powerStatus      = CEC_POWER_STATUS_STANDBY;
+  player.cecVersion       = CEC_VERSION_1_4;
+  player.strOSDName       = "Player";
+  AddDevice(player);
+}
+
+void CAdapterSimulator::SetErrorRates(uint32_t iNackPercentage, uint32_t iLineErrorPercentage, uint32_t iSeed /* = 1 */)
+{
+  m_iNackRate      = iNackPercentage;
+  m_iLineErrorRate = iLineErrorPercentage;
+  m_iRandom        = iSeed;
+}
+
+bool CAdapterSimulator::Start(const std::string &strPort /* = "" */)
+{
+  if (!m_transport || !m_transport->Open(strPort, 38400))
+    return false;
+
+  m_iBusFree      = GetTimeMs();
+  m_iNextKeypress = m_iBusFree + m_iKeypressInterval;
+  return CreateThread();
+}
+
+void CAdapterSimulator::Stop(void)
+{
+  /* the thread is blocked in Wait() until the host sends data, so wake it up before waiting for it to exit */
+  StopThread(false);
+  if (m_transport)
+    m_transport->Interrupt();
+  StopThread();
+
+  if (m_transport)
+    m_transport->Close();
+}
+
+std::string CAdapterSimulator::GetPortName(void) const
+{
+  return m_transport ? m_transport->GetName() : "";
+}
+
+std::string CAdapterSimulator::GetError(void) const
+{
+  return m_transport ? m_transport->GetError() : "no transport";
+}
+
+cec_sim_stats CAdapterSimulator::GetStats(void)
+{
+  CLockObject lock(&m_mutex);
+  return m_stats;
+}
+
+void *CAdapterSimulator::Process(void)
+{
+  while (!IsStopped())
+  {
+    if (m_transport->Wait(GetWaitTime()))
+      ReadFromHost();
+
+    if (m_iKeypressInterval > 0 && GetTimeMs() >= m_iNextKeypress)
+    {
+      SendKeypress();
+      m_iNextKeypress += m_iKeypressInterval;
+    }
+
+    WriteDueMessages();
+  }
+
+  return NULL;
+}
+
+uint32_t CAdapterSimulator::GetWaitTime(void) const
+{
+  int64_t iNow    = GetTimeMs();
+  int64_t iTarget = iNow + 1000;
+
+  if (!m_outQueue.empty() && m_outQueue.begin()->first < iTarget)
+    iTarget = m_outQueue.begin()->first;
+  if (m_iKeypressInterval > 0 && m_iNextKeypress < iTarget)
+    iTarget = m_iNextKeypress;
+
+  /* Wait(0) blocks until data arrives, so always pass at least one millisecond */
+  return iTarget > iNow ? (uint32_t) (iTarget - iNow) : 1;
+}
+
+void CAdapterSimulator::ReadFromHost(void)
+{
+  uint8_t buff[1024];
+  int32_t iBytesRead = m_transport->Read(buff, sizeof(buff));
+
+  for (int32_t iPtr = 0; iPtr < iBytesRead; iPtr++)
+  {
+    uint8_t byte = buff[iPtr];
+    if (!m_bGotStart)
+    {
+      if (byte == MSGSTART)
+        m_bGotStart = true;
+    }
+    else if (byte == MSGSTART)
+    {
+      /* a new message started before the previous one ended */
+      CLockObject lock(&m_mutex);
+      m_stats.iDecodeErrors++;
+      m_currentMessage.Clear();
+    }
+    else if (byte == MSGEND)
+    {
+      if (!m_currentMessage.IsEmpty())
+        HandleMessage(m_currentMessage);
+      m_currentMessage.Clear();
+      m_bGotStart = false;
+    }
+    else if (m_bNextIsEscaped)
+    {
+      m_currentMessage.PushBack(byte + (uint8_t)ESCOFFSET);
+      m_bNextIsEscaped = false;
+    }
+    else if (byte == MSGESC)
+    {
+      m_bNextIsEscaped = true;
+    }
+    else
+    {
+      m_currentMessage.PushBack(byte);
+    }
+  }
+}
+
+void CAdapterSimulator::HandleMessage(const cec_datapacket &msg)
+{
+  int64_t iNow = GetTimeMs();
+  cec_adapter_messagecode code = (cec_adapter_messagecode) (msg[0] & ~(MSGCODE_FRAME_EOM | MSGCODE_FRAME_ACK));
+  {
+    CLockObject lock(&m_mutex);
+    m_stats.iMessagesReceived++;
+  }
+
+  switch (code)
+  {
+  case MSGCODE_TRANSMIT_ACK_POLARITY:
+    if (msg.size >= 2)
+      m_bAckPolarityHigh = msg[1] != 0;
+    QueueMessage(iNow, MSGCODE_COMMAND_ACCEPTED);
+    break;
+  case MSGCODE_PING:
+  case MSGCODE_TRANSMIT_IDLETIME:
+  case MSGCODE_TRANSMIT_LINE_TIMEOUT:
+  case MSGCODE_START_BOOTLOADER:
+    QueueMessage(iNow, MSGCODE_COMMAND_ACCEPTED);
+    break;
+  case MSGCODE_SET_ACK_MASK:
+    if (msg.size >= 3)
+      m_iAckMask = (uint16_t) ((msg[1] << 8) | msg[2]);
+    QueueMessage(iNow, MSGCODE_COMMAND_ACCEPTED);
+    break;
+  case MSGCODE_FIRMWARE_VERSION:
+    {
+      uint8_t version[2] = { 0x00, 0x01 };
+      QueueMessage(iNow, MSGCODE_FIRMWARE_VERSION, version, 2);
+    }
+    break;
+  case MSGCODE_TRANSMIT:
+  case MSGCODE_TRANSMIT_EOM:
+    if (msg.size < 2)
+    {
+      QueueMessage(iNow, MSGCODE_COMMAND_REJECTED);
+      break;
+    }
+    m_currentFrame.PushBack(msg[1]);
+    QueueMessage(iNow, MSGCODE_COMMAND_ACCEPTED);
+    if (code == MSGCODE_TRANSMIT_EOM)
+    {
+      HandleFrame(m_currentFrame);
+      m_currentFrame.Clear();
+    }
+    break;
+  default:
+    QueueMessage(iNow, MSGCODE_COMMAND_REJECTED);
+    break;
+  }
+}
+
+void CAdapterSimulator::HandleFrame(const cec_command &frame)
+{
+  /* the frame is sent when the bus is free, and the result is known after the last byte */
+  unsigned int iBytes = 1 + (frame.opcode_set ? 1 : 0) + frame.parameters.size;
+  int64_t iStart = max(GetTimeMs(), m_iBusFree);
+  int64_t iEnd   = iStart + BusTime(CEC_SIM_START_BIT_TIME + iBytes * CEC_SIM_BYTE_TIME);
+  m_iBusFree = iEnd;
+
+  bool bBroadcast(frame.destination == CECDEVICE_BROADCAST);
+  cec_sim_device *device = GetDevice(frame.destination);
+  cec_adapter_messagecode result(MSGCODE_TRANSMIT_SUCCEEDED);
+
+  /* a follower acks a direct frame by pulling the ack bit low, and only pulls it low on a broadcast to reject it.
+     the adapter reports success when the bit matches the polarity that was set before the frame */
+  bool bAckBitLow(!bBroadcast && device && !RandomPercentage(m_iNackRate));
+  if (RandomPercentage(m_iLineErrorRate))
+    result = MSGCODE_TRANSMIT_FAILED_LINE;
+  else if (bAckBitLow == m_bAckPolarityHigh)
+    result = MSGCODE_TRANSMIT_FAILED_ACK;
+
+  {
+    CLockObject lock(&m_mutex);
+    m_stats.iFramesTransmitted++;
+    if (result == MSGCODE_TRANSMIT_FAILED_LINE)
+      m_stats.iLineErrors++;
+    else if (result == MSGCODE_TRANSMIT_FAILED_ACK)
+      m_stats.iFramesNacked++;
+    else
+      m_stats.iFramesAcked++;
+  }
+
+  QueueMessage(iEnd, result);
+
+  /* only frames that made it to the other side are answered */
+  if (result != MSGCODE_TRANSMIT_SUCCEEDED || !frame.opcode_set)
+    return;
+
+  if (bBroadcast)
+  {
+    for (vector<cec_sim_device>::iterator it = m_devices.begin(); it != m_devices.end(); it++)
+    {
+      if (it->address != frame.initiator)
+        HandleCommand(*it, frame);
+    }
+  }
+  else
+  {
+    HandleCommand(*device, frame);
+  }
+}
+
+void CAdapterSimulator::HandleCommand(cec_sim_device &device, const cec_command &frame)
+{
+  bool bDirect(frame.destination != CECDEVICE_BROADCAST);
+  cec_command reply;
+  reply.Clear();
+
+  switch (frame.opcode)
+  {
+  case CEC_OPCODE_GIVE_PHYSICAL_ADDRESS:
+    cec_command::Format(reply, device.address, CECDEVICE_BROADCAST, CEC_OPCODE_REPORT_PHYSICAL_ADDRESS);
+    reply.parameters.PushBack((uint8_t) (device.iPhysicalAddress >> 8));
+    reply.parameters.PushBack((uint8_t) (device.iPhysicalAddress & 0xFF));
+    reply.parameters.PushBack((uint8_t) GetDeviceType(device.address));
+    break;
+  case CEC_OPCODE_GIVE_DEVICE_VENDOR_ID:
+    cec_command::Format(reply, device.address, CECDEVICE_BROADCAST, CEC_OPCODE_DEVICE_VENDOR_ID);
+    reply.parameters.PushBack((uint8_t) ((device.iVendorId >> 16) & 0xFF));
+    reply.parameters.PushBack((uint8_t) ((device.iVendorId >> 8) & 0xFF));
+    reply.parameters.PushBack((uint8_t) (device.iVendorId & 0xFF));
+    break;
+  case CEC_OPCODE_GIVE_DEVICE_POWER_STATUS:
+    cec_command::Format(reply, device.address, frame.initiator, CEC_OPCODE_REPORT_POWER_STATUS);
+    reply.parameters.PushBack((uint8_t) device.powerStatus);
+    break;
+  case CEC_OPCODE_GET_CEC_VERSION:
+    cec_command::Format(reply, device.address, frame.initiator, CEC_OPCODE_CEC_VERSION);
+    reply.parameters.PushBack((uint8_t) device.cecVersion);
+    break;
+  case CEC_OPCODE_GIVE_OSD_NAME:
+    cec_command::Format(reply, device.address, frame.initiator, CEC_OPCODE_SET_OSD_NAME);
+    for (size_t iPtr = 0; iPtr < device.strOSDName.length() && iPtr < 14; iPtr++)
+      reply.parameters.PushBack((uint8_t) device.strOSDName[iPtr]);
+    break;
+  case CEC_OPCODE_GET_MENU_LANGUAGE:
+    if (device.strMenuLanguage.length() == 3)
+    {
+      cec_command::Format(reply, device.address, CECDEVICE_BROADCAST, CEC_OPCODE_SET_MENU_LANGUAGE);
+      for (size_t iPtr = 0; iPtr < 3; iPtr++)
+        reply.parameters.PushBack((uint8_t) device.strMenuLanguage[iPtr]);
+    }
+    else if (bDirect)
+    {
+      FormatFeatureAbort(reply, device.address, frame.initiator, frame.opcode);
+    }
+    break;
+  case CEC_OPCODE_GIVE_AUDIO_STATUS:
+    if (GetDeviceType(device.address) == CEC_DEVICE_TYPE_AUDIO_SYSTEM)
+    {
+      cec_command::Format(reply, device.address, frame.initiator, CEC_OPCODE_REPORT_AUDIO_STATUS);
+      reply.parameters.PushBack(0x32);
+    }
+    else if (bDirect)
+    {
+      FormatFeatureAbort(reply, device.address, frame.initiator, frame.opcode);
+    }
+    break;
+  case CEC_OPCODE_REQUEST_ACTIVE_SOURCE:
+    if (m_activeSource == device.address)
+    {
+      cec_command::Format(reply, device.address, CECDEVICE_BROADCAST, CEC_OPCODE_ACTIVE_SOURCE);
+      reply.parameters.PushBack((uint8_t) (device.iPhysicalAddress >> 8));
+      reply.parameters.PushBack((uint8_t) (device.iPhysicalAddress & 0xFF));
+    }
+    break;
+  case CEC_OPCODE_ACTIVE_SOURCE:
+    m_activeSource = frame.initiator;
+    break;
+  case CEC_OPCODE_IMAGE_VIEW_ON:
+  case CEC_OPCODE_TEXT_VIEW_ON:
+    device.powerStatus = CEC_POWER_STATUS_ON;
+    break;
+  case CEC_OPCODE_STANDBY:
+    device.powerStatus = CEC_POWER_STATUS_STANDBY;
+    break;
+  default:
+    if (bDirect && !IsReplyOrNotification(frame.opcode))
+      FormatFeatureAbort(reply, device.address, frame.initiator, frame.opcode);
+    break;
+  }
+
+  if (reply.opcode_set)
+    QueueFrame(reply);
+}
+
+void CAdapterSimulator::SendKeypress(void)
+{
+  if (!GetDevice(CECDEVICE_TV))
+    return;
+
+  /* send the key to the first address that the host acks */
+  for (uint8_t iPtr = 0; iPtr < 15; iPtr++)
+  {
+    if (m_iAckMask & (1 << iPtr))
+    {
+      cec_command command;
+      cec_command::Format(command, CECDEVICE_TV, (cec_logical_address) iPtr, CEC_OPCODE_USER_CONTROL_PRESSED);
+      command.parameters.PushBack((uint8_t) CEC_USER_CONTROL_CODE_SELECT);
+      QueueFrame(command);
+
+      cec_command::Format(command, CECDEVICE_TV, (cec_logical_address) iPtr, CEC_OPCODE_USER_CONTROL_RELEASE);
+      QueueFrame(command);
+      break;
+    }
+  }
+}
+
+void CAdapterSimulator::QueueMessage(int64_t iTime, cec_adapter_messagecode code, const uint8_t *data /* = NULL */, uint8_t iLength /* = 0 */)
+{
+  std::vector<uint8_t> message;
+  message.push_back(MSGSTART);
+
+  for (int iPtr = -1; iPtr < (int) iLength; iPtr++)
+  {
+    uint8_t byte = iPtr < 0 ? (uint8_t) code : data[iPtr];
+    if (byte >= MSGESC)
+    {
+      message.push_back(MSGESC);
+      message.push_back(byte - (uint8_t) ESCOFFSET);
+    }
+    else
+    {
+      message.push_back(byte);
+    }
+  }
+
+  message.push_back(MSGEND);
+  m_outQueue.insert(make_pair(iTime, message));
+}
+
+void CAdapterSimulator::QueueFrame(const cec_command &frame)
+{
+  /* the host receives every byte of the frame when it has been sent over the bus */
+  uint8_t data[sizeof(frame.parameters.data) + 2];
+  uint8_t iLength(0);
+  data[iLength++] = (uint8_t) ((frame.initiator << 4) | frame.destination);
+  if (frame.opcode_set)
+    data[iLength++] = (uint8_t) frame.opcode;
+  for (uint8_t iPtr = 0; iPtr < frame.parameters.size; iPtr++)
+    data[iLength++] = frame.parameters[iPtr];
+
+  bool bAcked = frame.destination == CECDEVICE_BROADCAST ||
+      (m_iAckMask & (1 << frame.destination)) != 0 ||
+      GetDevice(frame.destination) != NULL;
+
+  int64_t iStart = max(GetTimeMs(), m_iBusFree) + BusTime(CEC_SIM_RESPONSE_TIME);
+  for (uint8_t iPtr = 0; iPtr < iLength; iPtr++)
+  {
+    uint8_t code = (uint8_t) (iPtr == 0 ? MSGCODE_FRAME_START : MSGCODE_FRAME_DATA);
+    if (iPtr == iLength - 1)
+      code |= MSGCODE_FRAME_EOM;
+    if (bAcked)
+      code |= MSGCODE_FRAME_ACK;
+
+    m_iBusFree = iStart + BusTime(CEC_SIM_START_BIT_TIME + (iPtr + 1) * CEC_SIM_BYTE_TIME);
+    QueueMessage(m_iBusFree, (cec_adapter_messagecode) code, &data[iPtr], 1);
+  }
+
+  CLockObject lock(&m_mutex);
+  m_stats.iFramesSent++;
+}
+
+void CAdapterSimulator::WriteDueMessages(void)
+{
+  int64_t iNow = GetTimeMs();
+  while (!m_outQueue.empty() && m_outQueue.begin()->first <= iNow)
+  {
+    const std::vector<uint8_t> &message = m_outQueue.begin()->second;
+    m_transport->Write(&message[0], (uint32_t) message.size());
+    m_outQueue.erase(m_outQueue.begin());
+  }
+}
+
+int64_t CAdapterSimulator::BusTime(double fMs) const
+{
+  return (int64_t) (fMs * m_iTiming / 100.0 + 0.5);
+}
+
+bool CAdapterSimulator::RandomPercentage(uint32_t iPercentage)
+{
+  if (iPercentage == 0)
+    return false;
+
+  /* a simple LCG, so the same seed gives the same errors on every platform */
+  m_iRandom = m_iRandom * 1103515245 + 12345;
+  return ((m_iRandom >> 16) % 100) < iPercentage;
+}
+
+cec_sim_device *CAdapterSimulator::GetDevice(cec_logical_address address)
+{
+  for (vector<cec_sim_device>::iterator it = m_devices.begin(); it != m_devices.end(); it++)
+  {
+    if (it->address == address)
+      return &(*it);
+  }
+
+  return NULL;
+}
@@ -0,0 +1,187 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include <cectypes.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "../lib/platform/threads.h"
+
+namespace CEC
+{
+  class ITransport;
+
+  /*!
+   * @brief A device on the simulated bus.
+   */
+  typedef struct cec_sim_device
+  {
+    cec_logical_address address;
+    uint16_t            iPhysicalAddress;
+    uint64_t            iVendorId;
+    cec_power_status    powerStatus;
+    cec_version         cecVersion;
+    std::string         strOSDName;
+    std::string         strMenuLanguage;
+  } cec_sim_device;
+
+  /*!
+   * @brief Counters of what happened on the simulated bus.
+   */
+  typedef struct cec_sim_stats
+  {
+    uint64_t iMessagesReceived;   /*!< messages received from the host */
+    uint64_t iFramesTransmitted;  /*!< frames transmitted by the host */
+    uint64_t iFramesAcked;        /*!< frames that were acked by a device */
+    uint64_t iFramesNacked;       /*!< frames that were not acked */
+    uint64_t iLineErrors;         /*!< frames that failed with a line error */
+    uint64_t iFramesSent;         /*!< frames sent to the host by simulated devices */
+    uint64_t iDecodeErrors;       /*!< messages that could not be decoded */
+  } cec_sim_stats;
+
+  /*!
+   * @brief Implements the firmware side of the Pulse-Eight USB-CEC adapter protocol
+   *        and a set of devices on the CEC bus behind it, so libCEC can be used
+   *        without an adapter or TV attached.
+   */
+  class CAdapterSimulator : private CThread
+  {
+  public:
+    /*!
+     * @brief Create a new simulator.
+     * @param transport The transport to the host. Ownership is taken over.
+     */
+    CAdapterSimulator(ITransport *transport);
+    virtual ~CAdapterSimulator(void);
+
+    /*!
+     * @brief Add a device to the bus. Has to be called before Start().
+     * @param device The device to add.
+     */
+    void AddDevice(const cec_sim_device &device);
+
+    /*!
+     * @brief Add the default devices: a TV, an AVR and a player.
+     */
+    void AddDefaultDevices(void);
+
+    /*!
+     * @brief Change the timing of the bus.
+     * @param iPercentage 100 for the timing of a real CEC bus, 0 to run at full speed.
+     */
+    void SetTiming(uint32_t iPercentage) { m_iTiming = iPercentage; }
+
+    /*!
+     * @brief Make a percentage of the frames fail.
+     * @param iNackPercentage The percentage of directly addressed frames that is not acked.
+     * @param iLineErrorPercentage The percentage of frames that fails with a line error.
+     * @param iSeed The seed for the random generator, so failures can be reproduced.
+     */
+    void SetErrorRates(uint32_t iNackPercentage, uint32_t iLineErrorPercentage, uint32_t iSeed = 1);
+
+    /*!
+     * @brief Make the TV send a key press and release to the host.
+     * @param iIntervalMs The interval between key presses. 0 to disable.
+     */
+    void SetKeypressInterval(uint32_t iIntervalMs) { m_iKeypressInterval = iIntervalMs; }
+
+    /*!
+     * @brief Open the transport and start the simulation.
+     * @param strPort The port to pass to the transport.
+     * @return True when started, false otherwise.
+     */
+    bool Start(const std::string &strPort = "");
+
+    /*!
+     * @brief Stop the simulation and close the transport.
+     */
+    void Stop(void);
+
+    /*!
+     * @return The name of the port that the host has to open.
+     */
+    std::string GetPortName(void) const;
+
+    /*!
+     * @return The last error of the transport.
+     */
+    std::string GetError(void) const;
+
+    /*!
+     * @return A copy of the counters.
+     */
+    cec_sim_stats GetStats(void);
+
+    void *Process(void);
+
+  private:
+    void ReadFromHost(void);
+    void HandleMessage(const cec_datapacket &msg);
+    void HandleFrame(const cec_command &frame);
+    void HandleCommand(cec_sim_device &device, const cec_command &frame);
+    void SendKeypress(void);
+
+    void QueueMessage(int64_t iTime, cec_adapter_messagecode code, const uint8_t *data = NULL, uint8_t iLength = 0);
+    void QueueFrame(const cec_command &frame);
+    void WriteDueMessages(void);
+    uint32_t GetWaitTime(void) const;
+
+    int64_t BusTime(double fMs) const;
+    bool    RandomPercentage(uint32_t iPercentage);
+    cec_sim_device *GetDevice(cec_logical_address address);
+
+    ITransport *                                    m_transport;
+    std::vector<cec_sim_device>                     m_devices;
+    std::multimap<int64_t, std::vector<uint8_t> >   m_outQueue;
+    cec_sim_stats                                   m_stats;
+    uint32_t                                        m_iTiming;
+    uint32_t                                        m_iNackRate;
+    uint32_t                                        m_iLineErrorRate;
+    uint32_t                                        m_iRandom;
+    uint32_t                                        m_iKeypressInterval;
+    int64_t                                         m_iNextKeypress;
+    int64_t                                         m_iBusFree;
+    uint16_t                                        m_iAckMask;
+    bool                                            m_bAckPolarityHigh;
+    cec_logical_address                             m_activeSource;
+    CMutex                                          m_mutex;
+
+    /** @name Decoder state, only used by the simulator thread */
+    //@{
+    cec_datapacket                                  m_currentMessage;
+    cec_command                                     m_currentFrame;
+    bool                                            m_bGotStart;
+    bool                                            m_bNextIsEscaped;
+    //@}
+  };
+};
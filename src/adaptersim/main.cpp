@@ -0,0 +1,170 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <signal.h>
+#include "AdapterSimulator.h"
+#include "../lib/platform/ptyport.h"
+
+using namespace CEC;
+using namespace std;
+
+volatile sig_atomic_t g_bStop = 0;
+
+void StopHandler(int iSignal)
+{
+  (void) iSignal;
+  g_bStop = 1;
+}
+
+bool ParseDevice(const char *strDevice, cec_sim_device &device)
+{
+  /* {address}[:{physical address}[:{vendor id}[:{name}]]] */
+  unsigned int iAddress(0), iPhysicalAddress(0xFFFF), iVendorId(CEC_VENDOR_UNKNOWN);
+  char strName[15];
+  memset(strName, 0, sizeof(strName));
+
+  int iFields = sscanf(strDevice, "%x:%x:%x:%14s", &iAddress, &iPhysicalAddress, &iVendorId, strName);
+  if (iFields < 1 || iAddress >= CECDEVICE_BROADCAST)
+    return false;
+
+  device.address          = (cec_logical_address) iAddress;
+  device.iPhysicalAddress = (uint16_t) iPhysicalAddress;
+  device.iVendorId        = iVendorId;
+  device.powerStatus      = CEC_POWER_STATUS_ON;
+  device.cecVersion       = CEC_VERSION_1_3A;
+  device.strOSDName       = iFields >= 4 ? strName : "Device";
+  device.strMenuLanguage  = device.address == CECDEVICE_TV ? "eng" : "";
+  return true;
+}
+
+void ShowHelp(const char *strExec)
+{
+  printf("\n%s {-h|--help|options}\n\n"
+      "emulates a Pulse-Eight USB-CEC adapter and the devices on the CEC bus behind it.\n"
+      "the adapter is opened on a pseudo terminal, which can be passed to libCEC as com port.\n\n"
+      "parameters:\n"
+      "\t-h --help                  shows this help text\n"
+      "\t-d --device {la[:pa[:vendor[:name]]]}\n"
+      "\t                           adds a device with the given logical address, physical\n"
+      "\t                           address, vendor id and OSD name (hex values). more than\n"
+      "\t                           one is possible. a TV, an AVR and a player are added\n"
+      "\t                           when no device is given.\n"
+      "\t-t --timing {percentage}   the speed of the bus. 100 for the timing of a real CEC\n"
+      "\t                           bus (default), 0 to run at full speed.\n"
+      "\t-n --nack {percentage}     the percentage of directly addressed frames that is not acked.\n"
+      "\t-e --line-error {percentage}\n"
+      "\t                           the percentage of frames that fails with a line error.\n"
+      "\t-s --seed {n}              the seed for the random errors (default: 1).\n"
+      "\t-k --keys {ms}             makes the TV send a key press every {ms} milliseconds.\n\n",
+      strExec);
+}
+
+int main (int argc, char *argv[])
+{
+  CAdapterSimulator simulator(new CPtyTransport);
+  uint32_t iNackRate(0), iLineErrorRate(0), iSeed(1);
+  bool bHasDevices(false);
+
+  for (int iArgPtr = 1; iArgPtr < argc; iArgPtr++)
+  {
+    bool bHasValue(iArgPtr + 1 < argc);
+    if ((!strcmp(argv[iArgPtr], "-d") || !strcmp(argv[iArgPtr], "--device")) && bHasValue)
+    {
+      cec_sim_device device;
+      if (!ParseDevice(argv[++iArgPtr], device))
+      {
+        printf("invalid device '%s'\n", argv[iArgPtr]);
+        return 1;
+      }
+      simulator.AddDevice(device);
+      bHasDevices = true;
+    }
+    else if ((!strcmp(argv[iArgPtr], "-t") || !strcmp(argv[iArgPtr], "--timing")) && bHasValue)
+    {
+      simulator.SetTiming((uint32_t) atoi(argv[++iArgPtr]));
+    }
+    else if ((!strcmp(argv[iArgPtr], "-n") || !strcmp(argv[iArgPtr], "--nack")) && bHasValue)
+    {
+      iNackRate = (uint32_t) atoi(argv[++iArgPtr]);
+    }
+    else if ((!strcmp(argv[iArgPtr], "-e") || !strcmp(argv[iArgPtr], "--line-error")) && bHasValue)
+    {
+      iLineErrorRate = (uint32_t) atoi(argv[++iArgPtr]);
+    }
+    else if ((!strcmp(argv[iArgPtr], "-s") || !strcmp(argv[iArgPtr], "--seed")) && bHasValue)
+    {
+      iSeed = (uint32_t) atoi(argv[++iArgPtr]);
+    }
+    else if ((!strcmp(argv[iArgPtr], "-k") || !strcmp(argv[iArgPtr], "--keys")) && bHasValue)
+    {
+      simulator.SetKeypressInterval((uint32_t) atoi(argv[++iArgPtr]));
+    }
+    else
+    {
+      ShowHelp(argv[0]);
+      return 0;
+    }
+  }
+
+  if (!bHasDevices)
+    simulator.AddDefaultDevices();
+  simulator.SetErrorRates(iNackRate, iLineErrorRate, iSeed);
+
+  if (!simulator.Start())
+  {
+    printf("could not start the simulator: %s\n", simulator.GetError().c_str());
+    return 1;
+  }
+
+  signal(SIGINT, StopHandler);
+  signal(SIGTERM, StopHandler);
+
+  printf("%s\n", simulator.GetPortName().c_str());
+  fflush(stdout);
+
+  while (!g_bStop)
+    CCondition::Sleep(100);
+
+  simulator.Stop();
+
+  cec_sim_stats stats = simulator.GetStats();
+  printf("messages received: %llu, frames transmitted: %llu (acked: %llu, nacked: %llu, line errors: %llu), frames sent: %llu, decode errors: %llu\n",
+      (unsigned long long) stats.iMessagesReceived, (unsigned long long) stats.iFramesTransmitted,
+      (unsigned long long) stats.iFramesAcked, (unsigned long long) stats.iFramesNacked,
+      (unsigned long long) stats.iLineErrors, (unsigned long long) stats.iFramesSent,
+      (unsigned long long) stats.iDecodeErrors);
+
+  return 0;
+}
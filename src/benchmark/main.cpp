@@ -0,0 +1,487 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include <cec.h>
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <new>
+#include <vector>
+#include <poll.h>
+#include <sched.h>
+#include "../adaptersim/AdapterSimulator.h"
+#include "../lib/platform/loopback.h"
+#include "../lib/platform/ptyport.h"
+#include "../lib/platform/threads.h"
+#include "../lib/platform/timeutils.h"
+#include "../lib/util/buffer.h"
+#include "../lib/util/ringbuffer.h"
+
+using namespace CEC;
+using namespace std;
+
+#include <cecloader.h>
+
+#define CEC_BENCH_DEFAULT_ITEMS     2000000
+#define CEC_BENCH_MAX_BATCH         64
+#define CEC_BENCH_DEFAULT_TRANSMITS 200
+#define CEC_BENCH_RESPONSE_TIMEOUT  1000
+
+inline unsigned int PushEntries(CecBuffer<uint8_t> &buffer, const uint8_t *entries, unsigned int iCount)
+{
+  unsigned int iPtr(0);
+  while (iPtr < iCount && buffer.Push(entries[iPtr]))
+    iPtr++;
+  return iPtr;
+}
+
+inline unsigned int PopEntries(CecBuffer<uint8_t> &buffer, uint8_t *entries, unsigned int iMax)
+{
+  return buffer.Pop(entries, iMax);
+}
+
+inline unsigned int PushEntries(CecRingBuffer<uint8_t> &buffer, const uint8_t *entries, unsigned int iCount)
+{
+  return buffer.Push(entries, iCount);
+}
+
+inline unsigned int PopEntries(CecRingBuffer<uint8_t> &buffer, uint8_t *entries, unsigned int iMax)
+{
+  return buffer.Pop(entries, iMax);
+}
+
+/* both ends of an in-memory transport. entries are written to one end and read from the other */
+class CLoopbackPair
+{
+public:
+  CLoopbackPair(uint32_t iBufferSize) :
+    m_writer(iBufferSize),
+    m_reader(iBufferSize)
+  {
+    m_writer.Connect(&m_reader);
+    m_writer.Open("writer", 0);
+    m_reader.Open("reader", 0);
+  }
+
+  CLoopbackTransport m_writer;
+  CLoopbackTransport m_reader;
+};
+
+/* the transport blocks until everything has been written, so the producer never sees it full */
+inline unsigned int PushEntries(CLoopbackPair &pair, const uint8_t *entries, unsigned int iCount)
+{
+  int32_t iWritten = pair.m_writer.Write(entries, iCount);
+  return iWritten > 0 ? (unsigned int) iWritten : 0;
+}
+
+inline unsigned int PopEntries(CLoopbackPair &pair, uint8_t *entries, unsigned int iMax)
+{
+  int32_t iRead = pair.m_reader.Read(entries, iMax);
+  return iRead > 0 ? (unsigned int) iRead : 0;
+}
+
+/* the ring buffer only keeps its head and tail on cache lines of their own when it starts on a cache line,
+   which new and the stack don't guarantee */
+CecRingBuffer<uint8_t> *CreateAlignedRingBuffer(unsigned int iMinSize)
+{
+  void *storage(NULL);
+  if (posix_memalign(&storage, CEC_CACHE_LINE_SIZE, sizeof(CecRingBuffer<uint8_t>)) != 0)
+    return NULL;
+
+  assert(((uintptr_t) storage % CEC_CACHE_LINE_SIZE) == 0);
+  return new (storage) CecRingBuffer<uint8_t>(iMinSize);
+}
+
+void DestroyAlignedRingBuffer(CecRingBuffer<uint8_t> *buffer)
+{
+  buffer->~CecRingBuffer<uint8_t>();
+  free(buffer);
+}
+
+template<typename _BType>
+  class CBufferProducer : public CThread
+  {
+  public:
+    CBufferProducer(_BType &buffer, uint32_t iItems, unsigned int iBatchSize) :
+      m_buffer(buffer),
+      m_iItems(iItems),
+      m_iBatchSize(iBatchSize),
+      m_iFull(0) {}
+    virtual ~CBufferProducer(void) {}
+
+    void *Process(void)
+    {
+      uint8_t  data[CEC_BENCH_MAX_BATCH];
+      uint32_t iSent(0);
+
+      while (iSent < m_iItems && !IsStopped())
+      {
+        unsigned int iCount = m_iItems - iSent < m_iBatchSize ? m_iItems - iSent : m_iBatchSize;
+        for (unsigned int iPtr = 0; iPtr < iCount; iPtr++)
+          data[iPtr] = (uint8_t) (iSent + iPtr);
+
+        unsigned int iPushed(0);
+        while (iPushed < iCount && !IsStopped())
+        {
+          unsigned int iAdded = PushEntries(m_buffer, data + iPushed, iCount - iPushed);
+          if (iAdded == 0)
+          {
+            m_iFull++;
+            sched_yield();
+          }
+          iPushed += iAdded;
+        }
+        iSent += iCount;
+      }
+
+      return NULL;
+    }
+
+    uint64_t GetFullCount(void) const { return m_iFull; }
+
+  private:
+    _BType &     m_buffer;
+    uint32_t     m_iItems;
+    unsigned int m_iBatchSize;
+    uint64_t     m_iFull;
+  };
+
+template<typename _BType>
+  void RunBenchmark(const char *strName, _BType &buffer, uint32_t iItems, unsigned int iBatchSize)
+  {
+    CBufferProducer<_BType> producer(buffer, iItems, iBatchSize);
+    uint8_t  data[CEC_BENCH_MAX_BATCH];
+    uint32_t iReceived(0), iErrors(0);
+    uint64_t iEmpty(0);
+
+    int64_t iStart = GetTimeMs();
+    producer.CreateThread();
+    while (iReceived < iItems)
+    {
+      unsigned int iCount = PopEntries(buffer, data, iBatchSize);
+      if (iCount == 0)
+      {
+        iEmpty++;
+        sched_yield();
+      }
+
+      for (unsigned int iPtr = 0; iPtr < iCount; iPtr++)
+      {
+        if (data[iPtr] != (uint8_t) (iReceived + iPtr))
+          iErrors++;
+      }
+      iReceived += iCount;
+    }
+    int64_t iDuration = GetTimeMs() - iStart;
+    producer.StopThread();
+
+    printf("%-24s batch %2u: %8.2f Mentries/s  %6.1f ns/entry  full: %-8llu empty: %-8llu errors: %u\n",
+        strName, iBatchSize,
+        iDuration > 0 ? (double) iItems / (double) iDuration / 1000.0 : 0.0,
+        (double) iDuration * 1000000.0 / (double) iItems,
+        (unsigned long long) producer.GetFullCount(), (unsigned long long) iEmpty, iErrors);
+  }
+
+/* drain the log, so libCEC's buffer never fills up while measuring */
+unsigned int FlushLog(ICECAdapter *parser)
+{
+  unsigned int iErrors(0);
+  cec_log_message message;
+  while (parser->GetNextLogMessage(&message))
+  {
+    if (message.level == CEC_LOG_ERROR)
+      iErrors++;
+  }
+  return iErrors;
+}
+
+/* wait until the TV's power status is received, while draining the log */
+bool WaitForPowerStatus(ICECAdapter *parser, int iEventFd, unsigned int &iLogErrors)
+{
+  int64_t iNow    = GetTimeMs();
+  int64_t iTarget = iNow + CEC_BENCH_RESPONSE_TIMEOUT;
+  while (iNow < iTarget)
+  {
+    cec_command command;
+    while (parser->GetNextCommand(&command))
+    {
+      if (command.initiator == CECDEVICE_TV && command.opcode == CEC_OPCODE_REPORT_POWER_STATUS)
+        return true;
+    }
+    iLogErrors += FlushLog(parser);
+
+    if (iEventFd >= 0)
+    {
+      struct pollfd pfd;
+      pfd.fd      = iEventFd;
+      pfd.events  = POLLIN;
+      pfd.revents = 0;
+      poll(&pfd, 1, (int) (iTarget - iNow));
+    }
+    else
+    {
+      CCondition::Sleep(1);
+    }
+    iNow = GetTimeMs();
+  }
+
+  return false;
+}
+
+void PrintLatencies(const char *strName, vector<int64_t> &latencies, unsigned int iSucceeded, int64_t iDuration)
+{
+  if (latencies.empty())
+    return;
+
+  sort(latencies.begin(), latencies.end());
+  int64_t iTotal(0);
+  for (size_t iPtr = 0; iPtr < latencies.size(); iPtr++)
+    iTotal += latencies[iPtr];
+
+  printf("%-24s %4u/%-4u ok  min %4lld  avg %7.1f  p50 %4lld  p99 %4lld  max %4lld ms  %7.1f/s\n",
+      strName, iSucceeded, (unsigned int) latencies.size(),
+      (long long) latencies.front(), (double) iTotal / (double) latencies.size(),
+      (long long) latencies[latencies.size() / 2], (long long) latencies[latencies.size() * 99 / 100],
+      (long long) latencies.back(),
+      iDuration > 0 ? (double) latencies.size() * 1000.0 / (double) iDuration : 0.0);
+}
+
+bool RunLibCecBenchmark(const char *strPort, const char *strLib, uint32_t iTransmits)
+{
+  cec_device_type_list types;
+  types.Clear();
+  types.Add(CEC_DEVICE_TYPE_RECORDING_DEVICE);
+
+  ICECAdapter *parser = LibCecInit("cec-bench", types, strLib);
+  if (!parser)
+  {
+    printf("cannot load libCEC\n");
+    return false;
+  }
+
+  int64_t iStart = GetTimeMs();
+  if (!parser->Open(strPort))
+  {
+    printf("cannot open '%s'\n", strPort);
+    UnloadLibCec(parser);
+    return false;
+  }
+  printf("%-24s %lld ms\n", "open", (long long) (GetTimeMs() - iStart));
+  unsigned int iLogErrors = FlushLog(parser);
+
+  /* frames that are acked by the TV and not answered: the transmit path only */
+  vector<int64_t> latencies;
+  unsigned int iSucceeded(0);
+  iStart = GetTimeMs();
+  for (uint32_t iPtr = 0; iPtr < iTransmits; iPtr++)
+  {
+    cec_command command;
+    cec_command::Format(command, CECDEVICE_RECORDINGDEVICE1, CECDEVICE_TV, CEC_OPCODE_USER_CONTROL_RELEASE);
+
+    int64_t iTransmitStart = GetTimeMs();
+    if (parser->Transmit(command))
+      iSucceeded++;
+    latencies.push_back(GetTimeMs() - iTransmitStart);
+    iLogErrors += FlushLog(parser);
+  }
+  PrintLatencies("transmit", latencies, iSucceeded, GetTimeMs() - iStart);
+
+  /* a request and the TV's response, which is passed on as a received command. libCEC's
+     own requests like GetDevicePowerStatus() are answered from its cache after the first */
+  int iEventFd = parser->GetEventFd();
+  cec_command response;
+  while (parser->GetNextCommand(&response)) {}
+
+  latencies.clear();
+  iSucceeded = 0;
+  iStart = GetTimeMs();
+  for (uint32_t iPtr = 0; iPtr < iTransmits; iPtr++)
+  {
+    cec_command request;
+    cec_command::Format(request, CECDEVICE_RECORDINGDEVICE1, CECDEVICE_TV, CEC_OPCODE_GIVE_DEVICE_POWER_STATUS);
+
+    int64_t iRequestStart = GetTimeMs();
+    if (parser->Transmit(request) && WaitForPowerStatus(parser, iEventFd, iLogErrors))
+      iSucceeded++;
+    latencies.push_back(GetTimeMs() - iRequestStart);
+  }
+  PrintLatencies("request/response", latencies, iSucceeded, GetTimeMs() - iStart);
+
+  /* keypresses while the background queue is kept busy with requests */
+  latencies.clear();
+  iSucceeded = 0;
+  iStart = GetTimeMs();
+  for (uint32_t iPtr = 0; iPtr < iTransmits; iPtr++)
+  {
+    cec_command request;
+    cec_command::Format(request, CECDEVICE_RECORDINGDEVICE1, CECDEVICE_TV, CEC_OPCODE_GIVE_DEVICE_POWER_STATUS);
+    for (int iRequest = 0; iRequest < 4; iRequest++)
+      parser->TransmitAsync(request, NULL);
+
+    cec_command command;
+    cec_command::Format(command, CECDEVICE_RECORDINGDEVICE1, CECDEVICE_TV, CEC_OPCODE_USER_CONTROL_RELEASE);
+
+    int64_t iTransmitStart = GetTimeMs();
+    if (parser->Transmit(command))
+      iSucceeded++;
+    latencies.push_back(GetTimeMs() - iTransmitStart);
+    iLogErrors += FlushLog(parser);
+  }
+  PrintLatencies("transmit under load", latencies, iSucceeded, GetTimeMs() - iStart);
+
+  const char *strClasses[] = { "interactive", "response", "background" };
+  for (int iClass = CEC_TRANSMIT_CLASS_INTERACTIVE; iClass <= CEC_TRANSMIT_CLASS_MAX; iClass++)
+  {
+    cec_transmit_class_stats stats;
+    if (!parser->GetTransmitStats((cec_transmit_class) iClass, &stats))
+      continue;
+    printf("%-24s sent %6llu  aged %5llu  queued %3u (max %3u)  wait avg %7.1f  max %4u ms\n",
+        strClasses[iClass], (unsigned long long) stats.iTransmitted, (unsigned long long) stats.iAged,
+        stats.iQueued, stats.iMaxQueued,
+        stats.iTransmitted > 0 ? (double) stats.iTotalWaitMs / stats.iTransmitted : 0.0, stats.iMaxWaitMs);
+  }
+
+  iStart = GetTimeMs();
+  parser->Close();
+  printf("%-24s %lld ms\n", "close", (long long) (GetTimeMs() - iStart));
+  iLogErrors += FlushLog(parser);
+  printf("%-24s %u\n", "logged errors", iLogErrors);
+
+  UnloadLibCec(parser);
+  return true;
+}
+
+void ShowHelp(const char *strExec)
+{
+  printf("\n%s {-n items|-p port|-s}\n\n"
+      "without a port, compares the throughput of the buffers that are used between the\n"
+      "threads in libCEC and of the in-memory transport. one thread pushes bytes, the\n"
+      "other one pops and verifies them.\n\n"
+      "with a port or the built in adapter simulator, measures the latency and throughput\n"
+      "of transmissions and of requests that are answered, through the whole of libCEC.\n\n"
+      "parameters:\n"
+      "\t-h --help            shows this help text\n"
+      "\t-n --items {n}       the number of entries to push through each buffer (default: %d)\n"
+      "\t-p --port {port}     benchmark libCEC on the given com port\n"
+      "\t-s --sim             benchmark libCEC on a simulated adapter\n"
+      "\t-t --timing {n}      the speed of the simulated bus in percent. 100 for the timing\n"
+      "\t                     of a real CEC bus, 0 to run at full speed (default: 0)\n"
+      "\t-c --count {n}       the number of transmissions and requests (default: %d)\n"
+      "\t-l --lib {path}      the libCEC library to load\n\n",
+      strExec, CEC_BENCH_DEFAULT_ITEMS, CEC_BENCH_DEFAULT_TRANSMITS);
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t iItems(CEC_BENCH_DEFAULT_ITEMS);
+  uint32_t iTransmits(CEC_BENCH_DEFAULT_TRANSMITS);
+  uint32_t iTiming(0);
+  const char *strPort(NULL);
+  const char *strLib(NULL);
+  bool bSimulate(false);
+
+  for (int iArgPtr = 1; iArgPtr < argc; iArgPtr++)
+  {
+    bool bHasValue(iArgPtr + 1 < argc);
+    if ((!strcmp(argv[iArgPtr], "-n") || !strcmp(argv[iArgPtr], "--items")) && bHasValue)
+    {
+      iItems = (uint32_t) atoi(argv[++iArgPtr]);
+    }
+    else if ((!strcmp(argv[iArgPtr], "-p") || !strcmp(argv[iArgPtr], "--port")) && bHasValue)
+    {
+      strPort = argv[++iArgPtr];
+    }
+    else if (!strcmp(argv[iArgPtr], "-s") || !strcmp(argv[iArgPtr], "--sim"))
+    {
+      bSimulate = true;
+    }
+    else if ((!strcmp(argv[iArgPtr], "-t") || !strcmp(argv[iArgPtr], "--timing")) && bHasValue)
+    {
+      iTiming = (uint32_t) atoi(argv[++iArgPtr]);
+    }
+    else if ((!strcmp(argv[iArgPtr], "-c") || !strcmp(argv[iArgPtr], "--count")) && bHasValue)
+    {
+      iTransmits = (uint32_t) atoi(argv[++iArgPtr]);
+    }
+    else if ((!strcmp(argv[iArgPtr], "-l") || !strcmp(argv[iArgPtr], "--lib")) && bHasValue)
+    {
+      strLib = argv[++iArgPtr];
+    }
+    else
+    {
+      ShowHelp(argv[0]);
+      return 0;
+    }
+  }
+
+  if (bSimulate)
+  {
+    CAdapterSimulator simulator(new CPtyTransport);
+    simulator.AddDefaultDevices();
+    simulator.SetTiming(iTiming);
+    if (!simulator.Start())
+    {
+      printf("could not start the simulator: %s\n", simulator.GetError().c_str());
+      return 1;
+    }
+
+    printf("simulated adapter on %s, bus timing %u%%\n", simulator.GetPortName().c_str(), iTiming);
+    return RunLibCecBenchmark(simulator.GetPortName().c_str(), strLib, iTransmits) ? 0 : 1;
+  }
+  else if (strPort)
+  {
+    return RunLibCecBenchmark(strPort, strLib, iTransmits) ? 0 : 1;
+  }
+
+  unsigned int batchSizes[] = { 1, 16, CEC_BENCH_MAX_BATCH };
+  for (unsigned int iPtr = 0; iPtr < sizeof(batchSizes) / sizeof(unsigned int); iPtr++)
+  {
+    CecBuffer<uint8_t> queue;
+    RunBenchmark("CecBuffer (100)", queue, iItems, batchSizes[iPtr]);
+
+    CecRingBuffer<uint8_t> *ring = CreateAlignedRingBuffer(128);
+    if (ring)
+    {
+      RunBenchmark("CecRingBuffer (128)", *ring, iItems, batchSizes[iPtr]);
+      DestroyAlignedRingBuffer(ring);
+    }
+
+    CLoopbackPair loopback(128);
+    RunBenchmark("CLoopbackTransport (128)", loopback, iItems, batchSizes[iPtr]);
+  }
+
+  return 0;
+}
@@ -36,10 +36,65 @@
 #include "platform/serialport.h"
 #include "util/StdString.h"
 #include "platform/timeutils.h"
+#include "util/log.h"
+#include <string.h>
 
 using namespace std;
 using namespace CEC;
 
+/* the time in ms after which a queued frame is sent before frames of higher classes */
+#define CEC_TRANSMIT_AGE_RESPONSE   250
+#define CEC_TRANSMIT_AGE_BACKGROUND 1000
+
+static cec_transmit_class GetTransmitClass(const cec_command &command)
+{
+  /* polls are only sent while looking for devices or addresses */
+  if (command.opcode_set == 0)
+    return CEC_TRANSMIT_CLASS_BACKGROUND;
+
+  switch (command.opcode)
+  {
+  case CEC_OPCODE_USER_CONTROL_PRESSED:
+  case CEC_OPCODE_USER_CONTROL_RELEASE:
+  case CEC_OPCODE_VENDOR_REMOTE_BUTTON_DOWN:
+  case CEC_OPCODE_VENDOR_REMOTE_BUTTON_UP:
+  case CEC_OPCODE_GIVE_AUDIO_STATUS:
+  case CEC_OPCODE_DECK_CONTROL:
+  case CEC_OPCODE_PLAY:
+  case CEC_OPCODE_ACTIVE_SOURCE:
+  case CEC_OPCODE_INACTIVE_SOURCE:
+  case CEC_OPCODE_IMAGE_VIEW_ON:
+  case CEC_OPCODE_TEXT_VIEW_ON:
+  case CEC_OPCODE_STANDBY:
+  case CEC_OPCODE_SET_STREAM_PATH:
+  case CEC_OPCODE_ROUTING_CHANGE:
+  case CEC_OPCODE_SET_OSD_STRING:
+  case CEC_OPCODE_SET_SYSTEM_AUDIO_MODE:
+  case CEC_OPCODE_SYSTEM_AUDIO_MODE_REQUEST:
+  case CEC_OPCODE_TUNER_STEP_DECREMENT:
+  case CEC_OPCODE_TUNER_STEP_INCREMENT:
+  case CEC_OPCODE_SELECT_ANALOGUE_SERVICE:
+  case CEC_OPCODE_SELECT_DIGITAL_SERVICE:
+  case CEC_OPCODE_RECORD_ON:
+  case CEC_OPCODE_RECORD_OFF:
+    return CEC_TRANSMIT_CLASS_INTERACTIVE;
+  case CEC_OPCODE_GIVE_PHYSICAL_ADDRESS:
+  case CEC_OPCODE_GIVE_DEVICE_VENDOR_ID:
+  case CEC_OPCODE_GIVE_DEVICE_POWER_STATUS:
+  case CEC_OPCODE_GIVE_OSD_NAME:
+  case CEC_OPCODE_GIVE_DECK_STATUS:
+  case CEC_OPCODE_GIVE_TUNER_DEVICE_STATUS:
+  case CEC_OPCODE_GIVE_SYSTEM_AUDIO_MODE_STATUS:
+  case CEC_OPCODE_GET_CEC_VERSION:
+  case CEC_OPCODE_GET_MENU_LANGUAGE:
+  case CEC_OPCODE_REQUEST_ACTIVE_SOURCE:
+    return CEC_TRANSMIT_CLASS_BACKGROUND;
+  default:
+    /* reports, feature aborts and other replies */
+    return CEC_TRANSMIT_CLASS_RESPONSE;
+  }
+}
+
 CCECAdapterMessage::CCECAdapterMessage(const cec_command &command)
 {
   clear();
@@ -86,6 +141,7 @@ CCECAdapterMessage::CCECAdapterMessage(const cec_command &command)
 
   // set timeout
   transmit_timeout = command.transmit_timeout;
+  transmit_class   = GetTransmitClass(command);
 }
 
 CCECAdapterMessage &CCECAdapterMessage::operator =(const CCECAdapterMessage &msg)
@@ -227,6 +283,73 @@ bool CCECAdapterMessage::is_error(void) const
     code == MSGCODE_TRANSMIT_FAILED_TIMEOUT_LINE);
 }
 
+bool CCECAdapterMessage::is_transmit_reply(void) const
+{
+  cec_adapter_messagecode code = message();
+  return (code == MSGCODE_COMMAND_ACCEPTED ||
+    code == MSGCODE_COMMAND_REJECTED ||
+    code == MSGCODE_TRANSMIT_SUCCEEDED ||
+    code == MSGCODE_TRANSMIT_LINE_TIMEOUT ||
+    code == MSGCODE_TRANSMIT_FAILED_LINE ||
+    code == MSGCODE_TRANSMIT_FAILED_ACK ||
+    code == MSGCODE_TRANSMIT_FAILED_TIMEOUT_DATA ||
+    code == MSGCODE_TRANSMIT_FAILED_TIMEOUT_LINE);
+}
+
+bool CCECAdapterMessage::is_done(void) const
+{
+  return (state == ADAPTER_MESSAGE_STATE_SENT ||
+    state == ADAPTER_MESSAGE_STATE_SENT_ACKED ||
+    state == ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED ||
+    state == ADAPTER_MESSAGE_STATE_ERROR);
+}
+
+cec_transmit_status CCECAdapterMessage::transmit_status(void) const
+{
+  switch (state)
+  {
+  case ADAPTER_MESSAGE_STATE_SENT:
+  case ADAPTER_MESSAGE_STATE_SENT_ACKED:
+    return CEC_TRANSMIT_STATUS_ACKED;
+  case ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED:
+    switch (reply)
+    {
+    case MSGCODE_NOTHING:
+      return CEC_TRANSMIT_STATUS_TIMEOUT;
+    case MSGCODE_TRANSMIT_FAILED_ACK:
+      return CEC_TRANSMIT_STATUS_NACKED;
+    case MSGCODE_TRANSMIT_LINE_TIMEOUT:
+    case MSGCODE_TRANSMIT_FAILED_LINE:
+    case MSGCODE_TRANSMIT_FAILED_TIMEOUT_DATA:
+    case MSGCODE_TRANSMIT_FAILED_TIMEOUT_LINE:
+      return CEC_TRANSMIT_STATUS_LINE_ERROR;
+    default:
+      return CEC_TRANSMIT_STATUS_ERROR;
+    }
+  case ADAPTER_MESSAGE_STATE_ERROR:
+    return CEC_TRANSMIT_STATUS_ERROR;
+  default:
+    return CEC_TRANSMIT_STATUS_PENDING;
+  }
+}
+
+uint8_t CCECAdapterMessage::frame_size(void) const
+{
+  /* every byte that goes out on the bus is sent to the adapter as a separate
+     MSGSTART, MSGCODE_TRANSMIT(_EOM), data, MSGEND packet */
+  uint8_t iSize(0);
+  for (uint8_t iPtr = 0; iPtr + 1 < size(); iPtr++)
+  {
+    if (at(iPtr) == MSGSTART)
+    {
+      uint8_t iCode = at(iPtr + 1) & ~(MSGCODE_FRAME_EOM | MSGCODE_FRAME_ACK);
+      if (iCode == MSGCODE_TRANSMIT || iCode == MSGCODE_TRANSMIT_EOM)
+        iSize++;
+    }
+  }
+  return iSize;
+}
+
 void CCECAdapterMessage::push_escaped(uint8_t byte)
 {
   if (byte >= MSGESC && byte != MSGSTART)
@@ -238,17 +361,42 @@ void CCECAdapterMessage::push_escaped(uint8_t byte)
     push_back(byte);
 }
 
-CAdapterCommunication::CAdapterCommunication(CLibCEC *controller) :
-    m_port(NULL),
-    m_controller(controller)
+CAdapterCommunication::CAdapterCommunication(CLibCEC *controller, ITransport *transport /* = NULL */) :
+    m_port(transport),
+    m_controller(controller),
+    m_inBuffer(128),
+    m_completedBuffer(256),
+    m_iNextWrite(0),
+    m_bWakeReader(false),
+    m_currentTransmission(NULL),
+    m_iPacketsLeft(0),
+    m_iTransmitTimeout(0),
+    m_bLastWasAged(false),
+    m_bGotStart(false),
+    m_bNextIsEscaped(false)
 {
-  m_port = new CSerialPort;
+  if (!m_port)
+    m_port = new CSerialPort;
+
+  for (int iPtr = 0; iPtr <= CEC_TRANSMIT_CLASS_MAX; iPtr++)
+  {
+    m_outBuffer[iPtr] = new CecRingBuffer<CCECAdapterMessage *>(128);
+    memset(&m_stats[iPtr], 0, sizeof(cec_transmit_class_stats));
+  }
 }
 
 CAdapterCommunication::~CAdapterCommunication(void)
 {
   Close();
 
+  /* completed async messages that nobody picked up are still owned by us */
+  CCECAdapterMessage *msg;
+  while (m_completedBuffer.Pop(msg))
+    delete msg;
+
+  for (int iPtr = 0; iPtr <= CEC_TRANSMIT_CLASS_MAX; iPtr++)
+    delete m_outBuffer[iPtr];
+
   if (m_port)
   {
     delete m_port;
@@ -272,9 +420,7 @@ bool CAdapterCommunication::Open(const char *strPort, uint16_t iBaudRate /* = 38
 
   if (!m_port->Open(strPort, iBaudRate))
   {
-    CStdString strError;
-    strError.Format("error opening serial port '%s': %s", strPort, m_port->GetError().c_str());
-    m_controller->AddLog(CEC_LOG_ERROR, strError);
+    LIB_CEC_LOG(m_controller, CEC_LOG_ERROR, "error opening serial port '%s': %s", strPort, m_port->GetError().c_str());
     return false;
   }
 
@@ -282,7 +428,7 @@ bool CAdapterCommunication::Open(const char *strPort, uint16_t iBaudRate /* = 38
 
   //clear any input bytes
   uint8_t buff[1024];
-  while (m_port->Read(buff, sizeof(buff), 500) > 0) {}
+  while (m_port->Wait(500) && m_port->Read(buff, sizeof(buff)) > 0) {}
 
   if (CreateThread())
   {
@@ -303,7 +449,27 @@ void CAdapterCommunication::Close(void)
   CLockObject lock(&m_mutex);
   m_startCondition.Broadcast();
   m_rcvCondition.Broadcast();
+
+  /* the thread is blocked in ReadFromDevice() until the adapter sends data, so wake it up before waiting for it to exit */
+  StopThread(false);
+  if (m_port)
+    m_port->Interrupt();
+  lock.Leave();
+
   StopThread();
+
+  /* the thread has stopped, so nobody is going to complete the pending messages anymore */
+  CLockObject writeLock(&m_writeMutex);
+  if (m_currentTransmission)
+  {
+    CompleteMessage(m_currentTransmission, ADAPTER_MESSAGE_STATE_ERROR);
+    m_currentTransmission = NULL;
+  }
+
+  CCECAdapterMessage *msg;
+  for (int iPtr = 0; iPtr <= CEC_TRANSMIT_CLASS_MAX; iPtr++)
+    while (m_outBuffer[iPtr]->Pop(msg))
+      CompleteMessage(msg, ADAPTER_MESSAGE_STATE_ERROR);
 }
 
 void *CAdapterCommunication::Process(void)
@@ -315,9 +481,12 @@ void *CAdapterCommunication::Process(void)
 
   while (!IsStopped())
   {
-    ReadFromDevice(500);
-    Sleep(5);
-    WriteNextCommand();
+    /* block until the adapter sends something, Write() queued a new command or
+       the bus is expected to be free again for a queued command */
+    ReadFromDevice(GetWriteDelay());
+    CheckTransmitTimeout();
+
+    while (!IsStopped() && WriteNextCommand()) {}
   }
 
   return NULL;
@@ -330,56 +499,305 @@ bool CAdapterCommunication::ReadFromDevice(uint32_t iTimeout)
   if (!m_port)
     return false;
 
-  iBytesRead = m_port->Read(buff, sizeof(buff), iTimeout);
-  if (iBytesRead < 0 || iBytesRead > 256)
+  if (!m_port->Wait(iTimeout))
+    return false;
+
+  iBytesRead = m_port->Read(buff, sizeof(buff));
+  if (iBytesRead < 0)
   {
-    CStdString strError;
-    strError.Format("error reading from serial port: %s", m_port->GetError().c_str());
-    m_controller->AddLog(CEC_LOG_ERROR, strError);
+    LIB_CEC_LOG(m_controller, CEC_LOG_ERROR, "error reading from serial port: %s", m_port->GetError().c_str());
     return false;
   }
   else if (iBytesRead > 0)
-    AddData(buff, (uint8_t) iBytesRead);
+    AddData(buff, (uint32_t) iBytesRead);
 
   return iBytesRead > 0;
 }
 
-void CAdapterCommunication::AddData(uint8_t *data, uint8_t iLen)
+void CAdapterCommunication::AddData(uint8_t *data, uint32_t iLen)
 {
-  CLockObject lock(&m_mutex);
-  for (unsigned int iPtr = 0; iPtr < iLen; iPtr++)
-    m_inBuffer.Push(data[iPtr]);
+  /* the decoder state is kept across calls, so messages can be split over multiple reads */
+  bool bGotMessage(false);
+  for (uint32_t iPtr = 0; iPtr < iLen; iPtr++)
+  {
+    uint8_t buf = data[iPtr];
+
+    if (!m_bGotStart)
+    {
+      m_bGotStart = (buf == MSGSTART);
+    }
+    else if (buf == MSGSTART) //we found a msgstart before msgend, this is not right, remove
+    {
+      m_controller->AddLog(CEC_LOG_ERROR, "received MSGSTART before MSGEND");
+      m_currentAdapterMessage.clear();
+      m_bNextIsEscaped = false;
+    }
+    else if (buf == MSGEND)
+    {
+      m_currentAdapterMessage.state = ADAPTER_MESSAGE_STATE_RECEIVED;
+      if (HandleTransmitReply(m_currentAdapterMessage))
+      {
+        /* consumed by the current transmission */
+      }
+      else if (m_inBuffer.Push(m_currentAdapterMessage))
+      {
+        bGotMessage = true;
+      }
+      else
+      {
+        LIB_CEC_LOG(m_controller, CEC_LOG_ERROR, "input buffer is full, message dropped (%u messages dropped)", (uint32_t) m_inBuffer.Overflows());
+      }
 
-  m_rcvCondition.Signal();
+      m_currentAdapterMessage.clear();
+      m_bGotStart      = false;
+      m_bNextIsEscaped = false;
+    }
+    else if (m_bNextIsEscaped)
+    {
+      m_currentAdapterMessage.push_back(buf + (uint8_t)ESCOFFSET);
+      m_bNextIsEscaped = false;
+    }
+    else if (buf == MSGESC)
+    {
+      m_bNextIsEscaped = true;
+    }
+    else
+    {
+      m_currentAdapterMessage.push_back(buf);
+    }
+  }
+
+  if (bGotMessage)
+  {
+    CLockObject lock(&m_mutex);
+    m_rcvCondition.Signal();
+  }
 }
 
-void CAdapterCommunication::WriteNextCommand(void)
+uint32_t CAdapterCommunication::GetWriteDelay(void) const
 {
-  CCECAdapterMessage *msg;
-  if (m_outBuffer.Pop(msg))
+  int64_t iNow = GetTimeMs();
+
+  /* nothing is written until the adapter replied to the current transmission or it timed out */
+  if (m_currentTransmission)
+    return m_iTransmitTimeout > iNow ? (uint32_t) (m_iTransmitTimeout - iNow) : 1;
+
+  if (!HasQueuedCommands())
+    return 0;
+
+  /* wait at least 1ms, 0 would block until the adapter sends something */
+  return m_iNextWrite > iNow ? (uint32_t) (m_iNextWrite - iNow) : 1;
+}
+
+bool CAdapterCommunication::HasQueuedCommands(void) const
+{
+  for (int iPtr = 0; iPtr <= CEC_TRANSMIT_CLASS_MAX; iPtr++)
+    if (!m_outBuffer[iPtr]->IsEmpty())
+      return true;
+  return false;
+}
+
+bool CAdapterCommunication::PopNextCommand(CCECAdapterMessage *&msg)
+{
+  static const int64_t iMaxAge[CEC_TRANSMIT_CLASS_MAX + 1] = { 0, CEC_TRANSMIT_AGE_RESPONSE, CEC_TRANSMIT_AGE_BACKGROUND };
+  int64_t iNow = GetTimeMs();
+  int iFirst(-1), iAged(-1);
+  int64_t iAgedWait(0);
+
+  /* strict priority, unless a frame of a lower class has been waiting for too long.
+     the frame that waited longest past its class' limit goes first then, but never twice in a
+     row, so a backlog of aged frames can't starve the higher classes either */
+  for (int iPtr = 0; iPtr <= CEC_TRANSMIT_CLASS_MAX; iPtr++)
   {
-    CLockObject lock(&msg->mutex);
-    if (m_port->Write(msg) != (int32_t) msg->size())
+    CCECAdapterMessage *head;
+    if (!m_outBuffer[iPtr]->Peek(head))
+      continue;
+
+    if (iFirst == -1)
     {
-      CStdString strError;
-      strError.Format("error writing to serial port: %s", m_port->GetError().c_str());
-      m_controller->AddLog(CEC_LOG_ERROR, strError);
-      msg->state = ADAPTER_MESSAGE_STATE_ERROR;
+      iFirst = iPtr;
+      continue;
     }
-    else
+
+    int64_t iWait = iNow - head->queued_time - iMaxAge[iPtr];
+    if (!m_bLastWasAged && iWait >= 0 && (iAged == -1 || iWait > iAgedWait))
     {
-      m_controller->AddLog(CEC_LOG_DEBUG, "command sent");
-      CCondition::Sleep((uint32_t) msg->size() * 24 /*data*/ + 5 /*start bit (4.5 ms)*/ + 10);
-      msg->state = ADAPTER_MESSAGE_STATE_SENT;
+      iAged     = iPtr;
+      iAgedWait = iWait;
     }
+  }
+
+  if (iFirst == -1)
+    return false;
+
+  int iClass = iAged != -1 ? iAged : iFirst;
+  if (!m_outBuffer[iClass]->Pop(msg))
+    return false;
+  m_bLastWasAged = iAged != -1;
+
+  CLockObject lock(&m_statsMutex);
+  cec_transmit_class_stats &stats = m_stats[iClass];
+  uint32_t iWaitMs = iNow > msg->queued_time ? (uint32_t) (iNow - msg->queued_time) : 0;
+  stats.iTransmitted++;
+  stats.iTotalWaitMs += iWaitMs;
+  if (iWaitMs > stats.iMaxWaitMs)
+    stats.iMaxWaitMs = iWaitMs;
+  if (iAged != -1)
+    stats.iAged++;
+
+  return true;
+}
+
+bool CAdapterCommunication::WriteNextCommand(void)
+{
+  CCECAdapterMessage *msg;
+  if (m_currentTransmission || GetTimeMs() < m_iNextWrite || !PopNextCommand(msg))
+    return false;
+
+  CLockObject lock(&msg->mutex);
+  if (m_port->Write(msg->packet.data, msg->size()) != (int32_t) msg->size())
+  {
+    LIB_CEC_LOG(m_controller, CEC_LOG_ERROR, "error writing to serial port: %s", m_port->GetError().c_str());
+    lock.Leave();
+    CompleteMessage(msg, ADAPTER_MESSAGE_STATE_ERROR);
+    return true;
+  }
+
+  m_controller->AddLog(CEC_LOG_DEBUG, "command sent");
+
+  uint8_t iFrameSize = msg->frame_size();
+  if (iFrameSize > 0 && msg->transmit_timeout > 0)
+  {
+    /* the adapter accepts every packet (the ack polarity and each byte of the frame) and then
+       reports whether the frame was acked. until then, this is the current transmission */
+    msg->state            = ADAPTER_MESSAGE_STATE_WAITING_FOR_ACK;
+    m_currentTransmission = msg;
+    m_iPacketsLeft        = iFrameSize + 1;
+    m_iTransmitTimeout    = GetTimeMs() + msg->transmit_timeout;
+    return true;
+  }
+
+  /* when the sender isn't waiting for the adapter's reply, we don't send anything else until
+     the frame is expected to be off the bus.
+     start bit (4.5ms) + 10 bits of 2.4ms per byte + 7 bit periods signal free time */
+  if (iFrameSize > 0)
+    m_iNextWrite = GetTimeMs() + 5 + (int64_t) iFrameSize * 24 + 17;
+
+  lock.Leave();
+  CompleteMessage(msg, ADAPTER_MESSAGE_STATE_SENT);
+
+  return true;
+}
+
+bool CAdapterCommunication::HandleTransmitReply(const CCECAdapterMessage &msg)
+{
+  if (!m_currentTransmission || !msg.is_transmit_reply())
+    return false;
+
+  if (m_controller->IsLogLevelEnabled(CEC_LOG_DEBUG))
+    m_controller->AddLog(CEC_LOG_DEBUG, msg.ToString());
+
+  switch (msg.message())
+  {
+  case MSGCODE_COMMAND_ACCEPTED:
+    if (m_iPacketsLeft > 0)
+      m_iPacketsLeft--;
+    return true;
+  case MSGCODE_TRANSMIT_SUCCEEDED:
+    m_currentTransmission->reply = msg.message();
+    CompleteMessage(m_currentTransmission, m_iPacketsLeft == 0 ? ADAPTER_MESSAGE_STATE_SENT_ACKED : ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED);
+    break;
+  default:
+    m_currentTransmission->reply = msg.message();
+    CompleteMessage(m_currentTransmission, ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED);
+    break;
+  }
+
+  m_currentTransmission = NULL;
+  return true;
+}
+
+void CAdapterCommunication::CheckTransmitTimeout(void)
+{
+  if (m_currentTransmission && GetTimeMs() >= m_iTransmitTimeout)
+  {
+    m_controller->AddLog(CEC_LOG_DEBUG, "did not receive ack");
+    CompleteMessage(m_currentTransmission, ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED);
+    m_currentTransmission = NULL;
+  }
+}
+
+void CAdapterCommunication::CompleteMessage(CCECAdapterMessage *msg, cec_adapter_message_state state)
+{
+  if (msg->async)
+  {
+    /* nobody is waiting for async messages. they're handed back to the processor,
+       which calls the callback and deletes the message */
+    msg->state = state;
+    if (!m_completedBuffer.Push(msg))
+    {
+      m_controller->AddLog(CEC_LOG_ERROR, "completed transmissions buffer is full, result dropped");
+      delete msg;
+      return;
+    }
+
+    CLockObject lock(&m_mutex);
+    m_rcvCondition.Signal();
+  }
+  else
+  {
+    /* the sender deletes the message as soon as it has been signaled, so don't touch it after that */
+    CLockObject lock(&msg->mutex);
+    msg->state = state;
     msg->condition.Signal();
   }
 }
 
+bool CAdapterCommunication::GetCompletedMessage(CCECAdapterMessage *&msg)
+{
+  return m_completedBuffer.Pop(msg);
+}
+
+bool CAdapterCommunication::GetTransmitStats(cec_transmit_class transmitClass, cec_transmit_class_stats &stats) const
+{
+  if (transmitClass < CEC_TRANSMIT_CLASS_INTERACTIVE || transmitClass > CEC_TRANSMIT_CLASS_MAX)
+    return false;
+
+  CLockObject lock(&m_statsMutex);
+  stats         = m_stats[transmitClass];
+  stats.iQueued = m_outBuffer[transmitClass]->Size();
+  return true;
+}
+
 bool CAdapterCommunication::Write(CCECAdapterMessage *data)
 {
-  data->state = ADAPTER_MESSAGE_STATE_WAITING;
-  m_outBuffer.Push(data);
+  /* the output buffers only support a single producer */
+  CLockObject lock(&m_writeMutex);
+  if (IsStopped() || !IsRunning())
+  {
+    m_controller->AddLog(CEC_LOG_ERROR, "connection is closed");
+    return false;
+  }
+
+  if (data->transmit_class < CEC_TRANSMIT_CLASS_INTERACTIVE || data->transmit_class > CEC_TRANSMIT_CLASS_MAX)
+    data->transmit_class = CEC_TRANSMIT_CLASS_RESPONSE;
+
+  CecRingBuffer<CCECAdapterMessage *> *buffer = m_outBuffer[data->transmit_class];
+  data->state       = ADAPTER_MESSAGE_STATE_WAITING;
+  data->queued_time = GetTimeMs();
+  if (!buffer->Push(data))
+  {
+    m_controller->AddLog(CEC_LOG_ERROR, "output buffer is full");
+    return false;
+  }
+
+  {
+    CLockObject statsLock(&m_statsMutex);
+    if (buffer->Size() > m_stats[data->transmit_class].iMaxQueued)
+      m_stats[data->transmit_class].iMaxQueued = buffer->Size();
+  }
+
+  m_port->Interrupt();
   return true;
 }
 
@@ -387,54 +805,34 @@ bool CAdapterCommunication::Read(CCECAdapterMessage &msg, uint32_t iTimeout)
 {
   CLockObject lock(&m_mutex);
 
-  msg.clear();
-  uint64_t iNow = GetTimeMs();
-  uint64_t iTarget = iNow + iTimeout;
-  bool bGotFullMessage(false);
-  bool bNextIsEscaped(false);
-  bool bGotStart(false);
+  int64_t iNow = GetTimeMs();
+  int64_t iTarget = iNow + iTimeout;
 
-  while(!bGotFullMessage && iNow < iTarget)
+  while (!m_inBuffer.Pop(msg))
   {
-    uint8_t buf = 0;
-    if (!m_inBuffer.Pop(buf))
-    {
-      if (!m_rcvCondition.Wait(&m_mutex, (uint32_t) (iTarget - iNow)))
-        return false;
-    }
+    /* return early, so the caller can handle completed async transmissions */
+    if (!m_completedBuffer.IsEmpty())
+      return false;
 
-    if (!bGotStart)
-    {
-      if (buf == MSGSTART)
-        bGotStart = true;
-      continue;
-    }
-    else if (buf == MSGSTART) //we found a msgstart before msgend, this is not right, remove
+    if (m_bWakeReader)
     {
-      m_controller->AddLog(CEC_LOG_ERROR, "received MSGSTART before MSGEND");
-      msg.clear();
-      bGotStart = true;
+      m_bWakeReader = false;
+      return false;
     }
 
-    if (buf == MSGEND)
-    {
-      bGotFullMessage = true;
-    }
-    else if (bNextIsEscaped)
-    {
-      msg.push_back(buf + (uint8_t)ESCOFFSET);
-      bNextIsEscaped = false;
-    }
-    else if (buf == MSGESC)
-      bNextIsEscaped = true;
-    else
-      msg.push_back(buf);
+    if (iNow >= iTarget || !m_rcvCondition.Wait(&m_mutex, (uint32_t) (iTarget - iNow)))
+      return false;
+    iNow = GetTimeMs();
   }
 
-  if (bGotFullMessage)
-    msg.state = ADAPTER_MESSAGE_STATE_RECEIVED;
+  return true;
+}
 
-  return bGotFullMessage;
+void CAdapterCommunication::WakeReader(void)
+{
+  CLockObject lock(&m_mutex);
+  m_bWakeReader = true;
+  m_rcvCondition.Broadcast();
 }
 
 std::string CAdapterCommunication::GetError(void) const
@@ -455,8 +853,16 @@ bool CAdapterCommunication::StartBootloader(void)
   output->push_escaped(MSGCODE_START_BOOTLOADER);
   output->push_back(MSGEND);
 
+  CLockObject lock(&output->mutex);
   if ((bReturn = Write(output)) == false)
     m_controller->AddLog(CEC_LOG_ERROR, "could not start the bootloader");
+  else
+  {
+    /* the message is only ours again when the communication thread is done with it */
+    while (!output->is_done())
+      output->condition.Wait(&output->mutex);
+  }
+  lock.Leave();
 
   delete output;
 
@@ -476,8 +882,16 @@ bool CAdapterCommunication::PingAdapter(void)
   output->push_escaped(MSGCODE_PING);
   output->push_back(MSGEND);
 
+  CLockObject lock(&output->mutex);
   if ((bReturn = Write(output)) == false)
     m_controller->AddLog(CEC_LOG_ERROR, "could not send ping command");
+  else
+  {
+    /* the message is only ours again when the communication thread is done with it */
+    while (!output->is_done())
+      output->condition.Wait(&output->mutex);
+  }
+  lock.Leave();
 
   // TODO check for pong
   delete output;
@@ -33,7 +33,7 @@
 
 #include <cectypes.h>
 #include "platform/threads.h"
-#include "util/buffer.h"
+#include "util/ringbuffer.h"
 #include "util/StdString.h"
 #include <string>
 
@@ -44,6 +44,9 @@ namespace CEC
     ADAPTER_MESSAGE_STATE_UNKNOWN = 0,
     ADAPTER_MESSAGE_STATE_WAITING,
     ADAPTER_MESSAGE_STATE_SENT,
+    ADAPTER_MESSAGE_STATE_WAITING_FOR_ACK,
+    ADAPTER_MESSAGE_STATE_SENT_ACKED,
+    ADAPTER_MESSAGE_STATE_SENT_NOT_ACKED,
     ADAPTER_MESSAGE_STATE_RECEIVED,
     ADAPTER_MESSAGE_STATE_ERROR
   } cec_adapter_message_state;
@@ -53,6 +56,7 @@ namespace CEC
   {
   public:
     CCECAdapterMessage(void) { clear(); }
+    CCECAdapterMessage(const CCECAdapterMessage &msg) { clear(); *this = msg; }
     CCECAdapterMessage(const cec_command &command);
     CCECAdapterMessage &operator =(const CCECAdapterMessage &msg);
     CStdString ToString(void) const;
@@ -62,7 +66,7 @@ namespace CEC
     uint8_t                 operator[](uint8_t pos) const { return packet[pos]; }
     uint8_t                 at(uint8_t pos) const         { return packet[pos]; }
     uint8_t                 size(void) const              { return packet.size; }
-    void                    clear(void)                   { state = ADAPTER_MESSAGE_STATE_UNKNOWN; transmit_timeout = 0; packet.Clear(); }
+    void                    clear(void)                   { state = ADAPTER_MESSAGE_STATE_UNKNOWN; transmit_timeout = 0; reply = MSGCODE_NOTHING; async = false; ticket = 0; callback = NULL; callback_param = NULL; transmit_class = CEC_TRANSMIT_CLASS_INTERACTIVE; queued_time = 0; packet.Clear(); }
     void                    shift(uint8_t iShiftBy)       { packet.Shift(iShiftBy); }
     void                    push_back(uint8_t add)        { packet.PushBack(add); }
     cec_adapter_messagecode message(void) const           { return packet.size >= 1 ? (cec_adapter_messagecode) (packet.At(0) & ~(MSGCODE_FRAME_EOM | MSGCODE_FRAME_ACK))  : MSGCODE_NOTHING; }
@@ -71,27 +75,64 @@ namespace CEC
     cec_logical_address     initiator(void) const         { return packet.size >= 2 ? (cec_logical_address) (packet.At(1) >> 4)  : CECDEVICE_UNKNOWN; };
     cec_logical_address     destination(void) const       { return packet.size >= 2 ? (cec_logical_address) (packet.At(1) & 0xF) : CECDEVICE_UNKNOWN; };
     bool                    is_error(void) const;
+    bool                    is_transmit_reply(void) const;
+    bool                    is_done(void) const;
+    uint8_t                 frame_size(void) const;
+    cec_transmit_status     transmit_status(void) const;
     void                    push_escaped(uint8_t byte);
 
     cec_datapacket            packet;
     cec_adapter_message_state state;
     int32_t                   transmit_timeout;
+    cec_adapter_messagecode   reply;
+    bool                      async;
+    uint32_t                  ticket;
+    CBCecTransmitDone         callback;
+    void *                    callback_param;
+    cec_transmit_class        transmit_class;
+    int64_t                   queued_time;
     CMutex                    mutex;
     CCondition                condition;
   };
 
-  class CSerialPort;
+  class ITransport;
   class CLibCEC;
 
   class CAdapterCommunication : private CThread
   {
   public:
-    CAdapterCommunication(CLibCEC *controller);
+    /*!
+     * @brief Create a new instance.
+     * @param controller The libCEC instance that owns this connection.
+     * @param transport The transport to talk to the adapter over. Ownership is taken over. A serial port is used when NULL.
+     */
+    CAdapterCommunication(CLibCEC *controller, ITransport *transport = NULL);
     virtual ~CAdapterCommunication();
 
     bool Open(const char *strPort, uint16_t iBaudRate = 38400, uint32_t iTimeoutMs = 10000);
     bool Read(CCECAdapterMessage &msg, uint32_t iTimeout = 1000);
     bool Write(CCECAdapterMessage *data);
+
+    /*!
+     * @brief Make the current or the next call to Read() return false without waiting for a message.
+     */
+    void WakeReader(void);
+
+    /*!
+     * @brief Get the next message that was sent with the async flag set and that has been completed.
+     *        The caller becomes the owner of the message.
+     * @param msg The completed message.
+     * @return True when a message was returned, false otherwise.
+     */
+    bool GetCompletedMessage(CCECAdapterMessage *&msg);
+
+    /*!
+     * @brief Get the queue statistics of a transmit class.
+     * @param transmitClass The class to get the statistics for.
+     * @param stats The statistics.
+     * @return True when the statistics were copied, false when the class is invalid.
+     */
+    bool GetTransmitStats(cec_transmit_class transmitClass, cec_transmit_class_stats &stats) const;
     bool PingAdapter(void);
     void Close(void);
     bool IsOpen(void) const;
@@ -102,16 +143,47 @@ namespace CEC
     bool StartBootloader(void);
 
   private:
-    void WriteNextCommand(void);
-    void AddData(uint8_t *data, uint8_t iLen);
+    bool WriteNextCommand(void);
+    bool PopNextCommand(CCECAdapterMessage *&msg);
+    bool HasQueuedCommands(void) const;
+    void AddData(uint8_t *data, uint32_t iLen);
     bool ReadFromDevice(uint32_t iTimeout);
+    uint32_t GetWriteDelay(void) const;
+    bool HandleTransmitReply(const CCECAdapterMessage &msg);
+    void CheckTransmitTimeout(void);
+    void CompleteMessage(CCECAdapterMessage *msg, cec_adapter_message_state state);
 
-    CSerialPort *                    m_port;
+    ITransport *                     m_port;
     CLibCEC *                        m_controller;
-    CecBuffer<uint8_t>               m_inBuffer;
-    CecBuffer<CCECAdapterMessage *>  m_outBuffer;
-    CMutex                           m_mutex;
+    CecRingBuffer<CCECAdapterMessage>   m_inBuffer;
+    CecRingBuffer<CCECAdapterMessage *> *m_outBuffer[CEC_TRANSMIT_CLASS_MAX + 1];
+    CecRingBuffer<CCECAdapterMessage *> m_completedBuffer;
+    CMutex                              m_mutex;
+    CMutex                              m_writeMutex;
+    mutable CMutex                      m_statsMutex;
+    cec_transmit_class_stats            m_stats[CEC_TRANSMIT_CLASS_MAX + 1];
     CCondition                       m_rcvCondition;
     CCondition                       m_startCondition;
+    int64_t                          m_iNextWrite;
+    bool                             m_bWakeReader;
+
+    /** @name Transmission that is waiting for the adapter's reply, only used by the I/O thread */
+    //@{
+    CCECAdapterMessage *             m_currentTransmission;
+    uint8_t                          m_iPacketsLeft;
+    int64_t                          m_iTransmitTimeout;
+    //@}
+
+    /** @name Scheduler state, only used by the I/O thread */
+    //@{
+    bool                             m_bLastWasAged;
+    //@}
+
+    /** @name Decoder state, only used by the I/O thread */
+    //@{
+    CCECAdapterMessage               m_currentAdapterMessage;
+    bool                             m_bGotStart;
+    bool                             m_bNextIsEscaped;
+    //@}
   };
 };
@@ -0,0 +1,152 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "CECOpcodeInfo.h"
+
+using namespace CEC;
+
+#define DIRECT    CEC_ADDRESSING_DIRECT
+#define BROADCAST CEC_ADDRESSING_BROADCAST
+#define ANY       CEC_ADDRESSING_ANY
+
+static const cec_opcode_info g_opcodes[] =
+{
+  /* opcode                                     name                         min max  addressing reply                                  abort */
+  { CEC_OPCODE_FEATURE_ABORT,                   "feature abort",              2,  2, DIRECT,    CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_IMAGE_VIEW_ON,                   "image view on",              0,  0, DIRECT,    CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_TUNER_STEP_INCREMENT,            "tuner step increment",       0,  0, DIRECT,    CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_TUNER_STEP_DECREMENT,            "tuner step decrement",       0,  0, DIRECT,    CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_TUNER_DEVICE_STATUS,             "tuner device status",        5,  8, DIRECT,    CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_GIVE_TUNER_DEVICE_STATUS,        "give tuner status",          1,  1, DIRECT,    CEC_OPCODE_TUNER_DEVICE_STATUS,         true  },
+  { CEC_OPCODE_RECORD_ON,                       "record on",                  1,  8, DIRECT,    CEC_OPCODE_RECORD_STATUS,               true  },
+  { CEC_OPCODE_RECORD_STATUS,                   "record status",              1,  1, DIRECT,    CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_RECORD_OFF,                      "record off",                 0,  0, DIRECT,    CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_TEXT_VIEW_ON,                    "text view on",               0,  0, DIRECT,    CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_RECORD_TV_SCREEN,                "record tv screen",           0,  0, DIRECT,    CEC_OPCODE_RECORD_ON,                   true  },
+  { CEC_OPCODE_GIVE_DECK_STATUS,                "give deck status",           1,  1, DIRECT,    CEC_OPCODE_DECK_STATUS,                 true  },
+  { CEC_OPCODE_DECK_STATUS,                     "deck status",                1,  1, DIRECT,    CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_SET_MENU_LANGUAGE,               "set menu language",          3,  3, ANY,       CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_CLEAR_ANALOGUE_TIMER,            "clear analogue timer",      11, 11, DIRECT,    CEC_OPCODE_TIMER_CLEARED_STATUS,        true  },
+  { CEC_OPCODE_SET_ANALOGUE_TIMER,              "set analogue timer",        11, 11, DIRECT,    CEC_OPCODE_TIMER_STATUS,                true  },
+  { CEC_OPCODE_TIMER_STATUS,                    "timer status",               1,  3, DIRECT,    CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_STANDBY,                         "standby",                    0,  0, ANY,       CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_PLAY,                            "play",                       1,  1, DIRECT,    CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_DECK_CONTROL,                    "deck control",               1,  1, DIRECT,    CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_TIMER_CLEARED_STATUS,            "timer cleared status",       1,  1, DIRECT,    CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_USER_CONTROL_PRESSED,            "user control pressed",       1,  5, DIRECT,    CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_USER_CONTROL_RELEASE,            "user control release",       0,  0, DIRECT,    CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_GIVE_OSD_NAME,                   "give osd name",              0,  0, DIRECT,    CEC_OPCODE_SET_OSD_NAME,                true  },
+  { CEC_OPCODE_SET_OSD_NAME,                    "set osd name",               1, 14, DIRECT,    CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_SET_OSD_STRING,                  "set osd string",             2, 14, DIRECT,    CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_SET_TIMER_PROGRAM_TITLE,         "set timer program title",    1, 14, DIRECT,    CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_SYSTEM_AUDIO_MODE_REQUEST,       "system audio mode request",  0,  2, DIRECT,    CEC_OPCODE_SET_SYSTEM_AUDIO_MODE,       true  },
+  { CEC_OPCODE_GIVE_AUDIO_STATUS,               "give audio status",          0,  0, DIRECT,    CEC_OPCODE_REPORT_AUDIO_STATUS,         true  },
+  { CEC_OPCODE_SET_SYSTEM_AUDIO_MODE,           "set system audio mode",      1,  1, ANY,       CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_REPORT_AUDIO_STATUS,             "report audio status",        1,  1, DIRECT,    CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_GIVE_SYSTEM_AUDIO_MODE_STATUS,   "give audio mode status",     0,  0, DIRECT,    CEC_OPCODE_SYSTEM_AUDIO_MODE_STATUS,    true  },
+  { CEC_OPCODE_SYSTEM_AUDIO_MODE_STATUS,        "system audio mode status",   1,  1, DIRECT,    CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_ROUTING_CHANGE,                  "routing change",             4,  4, BROADCAST, CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_ROUTING_INFORMATION,             "routing information",        2,  2, BROADCAST, CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_ACTIVE_SOURCE,                   "active source",              2,  2, BROADCAST, CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_GIVE_PHYSICAL_ADDRESS,           "give physical address",      0,  0, DIRECT,    CEC_OPCODE_REPORT_PHYSICAL_ADDRESS,     true  },
+  { CEC_OPCODE_REPORT_PHYSICAL_ADDRESS,         "report physical address",    3,  3, ANY,       CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_REQUEST_ACTIVE_SOURCE,           "request active source",      0,  0, BROADCAST, CEC_OPCODE_ACTIVE_SOURCE,               false },
+  { CEC_OPCODE_SET_STREAM_PATH,                 "set stream path",            2,  2, BROADCAST, CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_DEVICE_VENDOR_ID,                "device vendor id",           3,  3, ANY,       CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_VENDOR_COMMAND,                  "vendor command",             0, 14, DIRECT,    CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_VENDOR_REMOTE_BUTTON_DOWN,       "vendor remote button down",  0, 14, ANY,       CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_VENDOR_REMOTE_BUTTON_UP,         "vendor remote button up",    0,  0, ANY,       CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_GIVE_DEVICE_VENDOR_ID,           "give device vendor id",      0,  0, DIRECT,    CEC_OPCODE_DEVICE_VENDOR_ID,            true  },
+  { CEC_OPCODE_MENU_REQUEST,                    "menu request",               1,  1, DIRECT,    CEC_OPCODE_MENU_STATUS,                 true  },
+  { CEC_OPCODE_MENU_STATUS,                     "menu status",                1,  1, DIRECT,    CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_GIVE_DEVICE_POWER_STATUS,        "give device power status",   0,  0, DIRECT,    CEC_OPCODE_REPORT_POWER_STATUS,         true  },
+  { CEC_OPCODE_REPORT_POWER_STATUS,             "report power status",        1,  1, ANY,       CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_GET_MENU_LANGUAGE,               "get menu language",          0,  0, DIRECT,    CEC_OPCODE_SET_MENU_LANGUAGE,           true  },
+  { CEC_OPCODE_SELECT_ANALOGUE_SERVICE,         "select analogue service",    4,  4, DIRECT,    CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_SELECT_DIGITAL_SERVICE,          "set digital service",        7,  7, DIRECT,    CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_SET_DIGITAL_TIMER,               "set digital timer",         14, 14, DIRECT,    CEC_OPCODE_TIMER_STATUS,                true  },
+  { CEC_OPCODE_CLEAR_DIGITAL_TIMER,             "clear digital timer",       14, 14, DIRECT,    CEC_OPCODE_TIMER_CLEARED_STATUS,        true  },
+  { CEC_OPCODE_SET_AUDIO_RATE,                  "set audio rate",             1,  1, DIRECT,    CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_INACTIVE_SOURCE,                 "inactive source",            2,  2, ANY,       CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_CEC_VERSION,                     "cec version",                1,  1, DIRECT,    CEC_OPCODE_NONE,                        false },
+  { CEC_OPCODE_GET_CEC_VERSION,                 "get cec version",            0,  0, DIRECT,    CEC_OPCODE_CEC_VERSION,                 true  },
+  { CEC_OPCODE_VENDOR_COMMAND_WITH_ID,          "vendor command with id",     3, 14, ANY,       CEC_OPCODE_NONE,                        true  },
+  { CEC_OPCODE_CLEAR_EXTERNAL_TIMER,            "clear external timer",       9, 10, DIRECT,    CEC_OPCODE_TIMER_CLEARED_STATUS,        true  },
+  { CEC_OPCODE_SET_EXTERNAL_TIMER,              "set external timer",         9, 10, DIRECT,    CEC_OPCODE_TIMER_STATUS,                true  },
+  { CEC_OPCODE_ABORT,                           "abort",                      0,  0, DIRECT,    CEC_OPCODE_FEATURE_ABORT,               true  }
+};
+
+CCECOpcodeInfo CCECOpcodeInfo::m_info;
+
+CCECOpcodeInfo::CCECOpcodeInfo(void)
+{
+  for (unsigned int iPtr = 0; iPtr < 256; iPtr++)
+  {
+    m_entries[iPtr] = NULL;
+    m_bReply[iPtr]  = false;
+  }
+
+  for (unsigned int iPtr = 0; iPtr < sizeof(g_opcodes) / sizeof(g_opcodes[0]); iPtr++)
+  {
+    m_entries[(uint8_t)g_opcodes[iPtr].opcode] = &g_opcodes[iPtr];
+    if (g_opcodes[iPtr].reply != CEC_OPCODE_NONE)
+      m_bReply[(uint8_t)g_opcodes[iPtr].reply] = true;
+  }
+}
+
+const char *CCECOpcodeInfo::ToString(cec_opcode opcode)
+{
+  const cec_opcode_info *info = Get(opcode);
+  return info ? info->strName : "UNKNOWN";
+}
+
+cec_opcode CCECOpcodeInfo::GetReply(cec_opcode opcode)
+{
+  const cec_opcode_info *info = Get(opcode);
+  return info ? info->reply : CEC_OPCODE_NONE;
+}
+
+cec_frame_validation CCECOpcodeInfo::Validate(const cec_command &command)
+{
+  const cec_opcode_info *info = command.opcode_set ? Get(command.opcode) : NULL;
+  if (!info)
+    return CEC_FRAME_VALID;
+
+  if (command.parameters.size < info->iMinParameters)
+    return CEC_FRAME_TOO_SHORT;
+
+  uint8_t addressing = command.destination == CECDEVICE_BROADCAST ? CEC_ADDRESSING_BROADCAST : CEC_ADDRESSING_DIRECT;
+  if ((info->addressing & addressing) == 0)
+    return CEC_FRAME_MISADDRESSED;
+
+  return CEC_FRAME_VALID;
+}
@@ -0,0 +1,98 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include <cectypes.h>
+
+namespace CEC
+{
+  typedef enum cec_opcode_addressing
+  {
+    CEC_ADDRESSING_DIRECT    = 0x1,
+    CEC_ADDRESSING_BROADCAST = 0x2,
+    CEC_ADDRESSING_ANY       = 0x3
+  } cec_opcode_addressing;
+
+  typedef enum cec_frame_validation
+  {
+    CEC_FRAME_VALID = 0,
+    CEC_FRAME_TOO_SHORT,    /*!< the frame has less parameters than the opcode requires */
+    CEC_FRAME_MISADDRESSED  /*!< a broadcast only opcode was sent to a device, or the other way around */
+  } cec_frame_validation;
+
+  typedef struct cec_opcode_info
+  {
+    cec_opcode  opcode;
+    const char *strName;
+    uint8_t     iMinParameters;
+    uint8_t     iMaxParameters;
+    uint8_t     addressing;    /*!< a mask of cec_opcode_addressing values */
+    cec_opcode  reply;         /*!< the opcode of the reply, or CEC_OPCODE_NONE when no reply is sent */
+    bool        bFeatureAbort; /*!< a directly addressed frame that isn't supported or valid must be answered with a feature abort */
+  } cec_opcode_info;
+
+  /*!
+   * @brief What the CEC specification says about every opcode. The information is a constant table, and an index
+   *        by opcode is built when the library is loaded, so every method is a single lookup.
+   */
+  class CCECOpcodeInfo
+  {
+  public:
+    /*!
+     * @return The information about an opcode, or NULL when the opcode is unknown.
+     */
+    static const cec_opcode_info *Get(cec_opcode opcode) { return m_info.m_entries[(uint8_t)opcode]; }
+
+    static const char *ToString(cec_opcode opcode);
+    static cec_opcode  GetReply(cec_opcode opcode);
+
+    /*!
+     * @return True when the opcode is the reply to at least one other opcode.
+     */
+    static bool IsReply(cec_opcode opcode) { return m_info.m_bReply[(uint8_t)opcode]; }
+
+    /*!
+     * @brief Check the length and addressing of a received frame. Polls, unknown opcodes and extra parameters are
+     *        accepted, the latter because newer versions of the specification may add parameters. A frame that is
+     *        too short is reported before one that is misaddressed.
+     */
+    static cec_frame_validation Validate(const cec_command &command);
+
+  private:
+    CCECOpcodeInfo(void);
+
+    const cec_opcode_info *m_entries[256];
+    bool                   m_bReply[256];
+
+    static CCECOpcodeInfo  m_info;
+  };
+};
@@ -33,33 +33,54 @@
 #include "CECProcessor.h"
 
 #include "AdapterCommunication.h"
+#include "CECOpcodeInfo.h"
 #include "devices/CECBusDevice.h"
 #include "devices/CECAudioSystem.h"
 #include "devices/CECPlaybackDevice.h"
 #include "devices/CECRecordingDevice.h"
 #include "devices/CECTuner.h"
 #include "devices/CECTV.h"
+#include "implementations/ANCommandHandler.h"
 #include "implementations/CECCommandHandler.h"
+#include "implementations/SLCommandHandler.h"
+#include "implementations/VLCommandHandler.h"
 #include "LibCEC.h"
 #include "util/StdString.h"
 #include "platform/timeutils.h"
+#include "util/log.h"
 
 using namespace CEC;
 using namespace std;
 
+/* the time in ms to wait for the adapter to report whether a poll was acked. a poll is on the bus for less than 50ms */
+#define CEC_POLL_TIMEOUT 250
+
+/* the maximum time in ms that the processor thread waits for a frame when no timer expires earlier */
+#define CEC_PROCESSOR_MAX_WAIT 1000
+
 CCECProcessor::CCECProcessor(CLibCEC *controller, CAdapterCommunication *serComm, const char *strDeviceName, cec_logical_address iLogicalAddress /* = CECDEVICE_PLAYBACKDEVICE1 */, uint16_t iPhysicalAddress /* = CEC_DEFAULT_PHYSICAL_ADDRESS*/) :
     m_bStarted(false),
     m_iHDMIPort(CEC_DEFAULT_HDMI_PORT),
     m_strDeviceName(strDeviceName),
     m_communication(serComm),
     m_controller(controller),
-    m_bMonitor(false)
+    m_bMonitor(false),
+    m_iLastTicket(0),
+    m_bCachedPhysicalAddress(false),
+    m_bHandlingCommand(false),
+    m_timers(CEC_TIMER_COUNT)
 {
+  RegisterHandlers();
+
   m_logicalAddresses.Clear();
   m_logicalAddresses.Set(iLogicalAddress);
   m_types.clear();
   for (int iPtr = 0; iPtr <= 16; iPtr++)
     m_busDevices[iPtr] = new CCECBusDevice(this, (cec_logical_address) iPtr, iPtr == iLogicalAddress ? iPhysicalAddress : 0);
+
+  m_topology.SetPhysicalAddress(CECDEVICE_TV, 0);
+  if (iLogicalAddress != CECDEVICE_TV)
+    m_topology.SetPhysicalAddress(iLogicalAddress, iPhysicalAddress);
 }
 
 CCECProcessor::CCECProcessor(CLibCEC *controller, CAdapterCommunication *serComm, const char *strDeviceName, const cec_device_type_list &types) :
@@ -69,8 +90,14 @@ CCECProcessor::CCECProcessor(CLibCEC *controller, CAdapterCommunication *serComm
     m_types(types),
     m_communication(serComm),
     m_controller(controller),
-    m_bMonitor(false)
+    m_bMonitor(false),
+    m_iLastTicket(0),
+    m_bCachedPhysicalAddress(false),
+    m_bHandlingCommand(false),
+    m_timers(CEC_TIMER_COUNT)
 {
+  RegisterHandlers();
+
   m_logicalAddresses.Clear();
   for (int iPtr = 0; iPtr < 16; iPtr++)
   {
@@ -103,6 +130,8 @@ CCECProcessor::CCECProcessor(CLibCEC *controller, CAdapterCommunication *serComm
       break;
     }
   }
+
+  m_topology.SetPhysicalAddress(CECDEVICE_TV, 0);
 }
 
 CCECProcessor::~CCECProcessor(void)
@@ -113,6 +142,36 @@ CCECProcessor::~CCECProcessor(void)
   m_controller = NULL;
   for (unsigned int iPtr = 0; iPtr < 16; iPtr++)
     delete m_busDevices[iPtr];
+
+  for (map<cec_vendor_id, CCECCommandHandler *>::iterator it = m_handlers.begin(); it != m_handlers.end(); it++)
+    delete it->second;
+}
+
+void CCECProcessor::RegisterHandlers(void)
+{
+  /* the default handler, for devices without a vendor specific one */
+  RegisterHandler(new CCECCommandHandler(this));
+
+  RegisterHandler(new CANCommandHandler(this));
+  RegisterHandler(new CSLCommandHandler(this));
+  RegisterHandler(new CVLCommandHandler(this));
+}
+
+void CCECProcessor::RegisterHandler(CCECCommandHandler *handler)
+{
+  map<cec_vendor_id, CCECCommandHandler *>::iterator it = m_handlers.find(handler->GetVendorId());
+  if (it != m_handlers.end())
+    delete it->second;
+  m_handlers[handler->GetVendorId()] = handler;
+}
+
+CCECCommandHandler *CCECProcessor::GetHandler(cec_vendor_id vendor) const
+{
+  /* only changed in the constructor, so this doesn't need a lock */
+  map<cec_vendor_id, CCECCommandHandler *>::const_iterator it = m_handlers.find(vendor);
+  if (it == m_handlers.end())
+    it = m_handlers.find(CEC_VENDOR_UNKNOWN);
+  return it->second;
 }
 
 bool CCECProcessor::Start(void)
@@ -191,15 +250,34 @@ bool CCECProcessor::FindLogicalAddresses(void)
 {
   bool bReturn(true);
   m_logicalAddresses.Clear();
-  CStdString strLog;
+
+  /* try the address that we used last time first */
+  cec_device_type cachedType(CEC_DEVICE_TYPE_RESERVED);
+  if (m_deviceCache.IsLoaded())
+  {
+    cec_logical_address cachedAddress = (cec_logical_address) m_deviceCache.GetData().iLogicalAddress;
+    if (cachedAddress >= CECDEVICE_TV && cachedAddress < CECDEVICE_BROADCAST &&
+        m_types.IsSet(m_busDevices[cachedAddress]->GetType()))
+    {
+      LIB_CEC_LOG(m_controller, CEC_LOG_DEBUG, "%s - trying cached logical address '%s'", __FUNCTION__, m_busDevices[cachedAddress]->GetLogicalAddressName());
+      if (TryLogicalAddress(cachedAddress))
+        cachedType = m_busDevices[cachedAddress]->GetType();
+    }
+  }
 
   for (unsigned int iPtr = 0; iPtr < 5; iPtr++)
   {
     if (m_types.types[iPtr] == CEC_DEVICE_TYPE_RESERVED)
       continue;
 
-    strLog.Format("%s - device %d: type %d", __FUNCTION__, iPtr, m_types.types[iPtr]);
-    AddLog(CEC_LOG_DEBUG, strLog);
+    /* this type already got the cached address */
+    if (m_types.types[iPtr] == cachedType)
+    {
+      cachedType = CEC_DEVICE_TYPE_RESERVED;
+      continue;
+    }
+
+    LIB_CEC_LOG(m_controller, CEC_LOG_DEBUG, "%s - device %d: type %d", __FUNCTION__, iPtr, m_types.types[iPtr]);
 
     if (m_types.types[iPtr] == CEC_DEVICE_TYPE_RECORDING_DEVICE)
       bReturn &= FindLogicalAddressRecordingDevice();
@@ -249,15 +327,20 @@ void *CCECProcessor::Process(void)
     command.Clear();
     msg.clear();
 
+    HandleTransmitCallbacks();
+
+    /* sleep until the next frame arrives or the next timer expires */
+    uint32_t iWaitMs = RunTimers();
+    bool bOpen(false);
+
     {
       CLockObject lock(&m_mutex);
-      if (m_commandBuffer.Pop(command))
-      {
-        bParseFrame = true;
-      }
-      else if (m_communication->IsOpen() && m_communication->Read(msg, 50))
+      bOpen = m_communication->IsOpen();
+      if (bOpen && m_communication->Read(msg, iWaitMs))
       {
-        m_controller->AddLog(msg.is_error() ? CEC_LOG_WARNING : CEC_LOG_DEBUG, msg.ToString());
+        cec_log_level level = msg.is_error() ? CEC_LOG_WARNING : CEC_LOG_DEBUG;
+        if (m_controller->IsLogLevelEnabled(level))
+          m_controller->AddLog(level, msg.ToString());
         if ((bParseFrame = (ParseMessage(msg) && !IsStopped())) == true)
           command = m_currentframe;
       }
@@ -265,22 +348,48 @@ void *CCECProcessor::Process(void)
 
     if (bParseFrame)
       ParseCommand(command);
+    else if (!bOpen)
+      Sleep(iWaitMs);
     bParseFrame = false;
+  }
 
-    Sleep(5);
+  return NULL;
+}
 
-    m_controller->CheckKeypressTimeout();
+bool CCECProcessor::StopThread(bool bWaitForExit /* = true */)
+{
+  /* the thread waits for a frame, wake it up after setting the stop flag */
+  CThread::StopThread(false);
+  if (m_communication)
+    m_communication->WakeReader();
+  return CThread::StopThread(bWaitForExit);
+}
 
-    for (unsigned int iDevicePtr = 0; iDevicePtr < 16; iDevicePtr++)
+uint32_t CCECProcessor::RunTimers(void)
+{
+  int64_t iNow = GetTimeMs();
+  unsigned int iTimer;
+  while (m_timers.PopExpired(iNow, iTimer))
+  {
+    if (iTimer == CEC_TIMER_KEYPRESS_TIMEOUT)
     {
-      if (!m_logicalAddresses[iDevicePtr])
-        m_busDevices[iDevicePtr]->PollVendorId();
+      m_controller->CheckKeypressTimeout();
     }
-
-    Sleep(5);
+    else
+    {
+      /* PollVendorId() returns when to check again, or 0 when it's done */
+      uint8_t iAddress = (uint8_t) (iTimer - CEC_TIMER_VENDOR_POLL);
+      int64_t iNext = m_logicalAddresses[iAddress] ? 0 : m_busDevices[iAddress]->PollVendorId();
+      if (iNext > 0)
+        m_timers.Schedule(iTimer, iNext);
+    }
+    iNow = GetTimeMs();
   }
 
-  return NULL;
+  int64_t iDeadline = m_timers.NextDeadline();
+  if (iDeadline == 0 || iDeadline - iNow > CEC_PROCESSOR_MAX_WAIT)
+    return CEC_PROCESSOR_MAX_WAIT;
+  return (uint32_t) (iDeadline - iNow);
 }
 
 bool CCECProcessor::SetActiveSource(cec_device_type type /* = CEC_DEVICE_TYPE_RESERVED */)
@@ -354,26 +463,37 @@ bool CCECProcessor::SetHDMIPort(uint8_t iPort)
 {
   bool bReturn(false);
 
-  CStdString strLog;
-  strLog.Format("setting HDMI port to %d", iPort);
-  AddLog(CEC_LOG_DEBUG, strLog);
+  LIB_CEC_LOG(m_controller, CEC_LOG_DEBUG, "setting HDMI port to %d", iPort);
 
   m_iHDMIPort = iPort;
   if (!m_bStarted)
     return true;
 
-  uint16_t iPhysicalAddress(0);
-  int iPos = 3;
-  while(!bReturn && iPos >= 0)
+  /* use the physical address of the previous session when we're still connected to the same port. it's
+     detected again when another device reports the same address */
+  const cec_device_cache_data &cache = m_deviceCache.GetData();
+  if (m_bCachedPhysicalAddress && cache.iHDMIPort == iPort && cache.iPhysicalAddress != 0xFFFF)
   {
-    iPhysicalAddress += ((uint16_t)iPort * (0x1 << iPos*4));
-    strLog.Format("checking physical address %4x", iPhysicalAddress);
-    AddLog(CEC_LOG_DEBUG, strLog);
+    LIB_CEC_LOG(m_controller, CEC_LOG_DEBUG, "using cached physical address %4x", cache.iPhysicalAddress);
+    SetPhysicalAddress(cache.iPhysicalAddress);
+    return true;
+  }
+  m_bCachedPhysicalAddress = false;
+
+  /* when starting, this runs on the processor thread, which also handles the replies to physical address
+     requests. don't wait for them: only check the known addresses and request the others in the background */
+  ScanUnknownDevices(true);
+
+  /* we're connected to this port of the TV. when another device uses that address, assume that we're
+     connected to the same port of that device */
+  uint16_t iPhysicalAddress = CHDMITopology::GetChild(0, iPort);
+  while (!bReturn && iPhysicalAddress != CEC_INVALID_PHYSICAL_ADDRESS)
+  {
+    LIB_CEC_LOG(m_controller, CEC_LOG_DEBUG, "checking physical address %4x", iPhysicalAddress);
     if (CheckPhysicalAddress(iPhysicalAddress))
     {
-      strLog.Format("physical address %4x is in use", iPhysicalAddress);
-      AddLog(CEC_LOG_DEBUG, strLog);
-      iPos--;
+      LIB_CEC_LOG(m_controller, CEC_LOG_DEBUG, "physical address %4x is in use", iPhysicalAddress);
+      iPhysicalAddress = CHDMITopology::GetChild(iPhysicalAddress, iPort);
     }
     else
     {
@@ -387,12 +507,8 @@ bool CCECProcessor::SetHDMIPort(uint8_t iPort)
 
 bool CCECProcessor::CheckPhysicalAddress(uint16_t iPhysicalAddress)
 {
-  for (unsigned int iPtr = 0; iPtr < 16; iPtr++)
-  {
-    if (m_busDevices[iPtr]->GetPhysicalAddress(false) == iPhysicalAddress)
-      return true;
-  }
-  return false;
+  cec_logical_address iAddress = m_topology.GetLogicalAddress(iPhysicalAddress);
+  return iAddress != CECDEVICE_UNKNOWN && !m_logicalAddresses[iAddress];
 }
 
 bool CCECProcessor::SetStreamPath(uint16_t iStreamPath)
@@ -405,6 +521,12 @@ bool CCECProcessor::SetStreamPath(uint16_t iStreamPath)
     device->SetActiveDevice();
     bReturn = true;
   }
+  else if (CHDMITopology::IsValid(iStreamPath))
+  {
+    /* the stream is routed to a device that we don't know, so none of the known devices is the active source */
+    for (unsigned int iPtr = 0; iPtr < 16; iPtr++)
+      m_busDevices[iPtr]->SetInactiveDevice();
+  }
 
   return bReturn;
 }
@@ -421,23 +543,14 @@ bool CCECProcessor::SetInactiveView(void)
 
 void CCECProcessor::LogOutput(const cec_command &data)
 {
-  CStdString strTx;
-  strTx.Format("<< %02x", ((uint8_t)data.initiator << 4) + (uint8_t)data.destination);
-  if (data.opcode_set)
-      strTx.AppendFormat(":%02x", (uint8_t)data.opcode);
-
-  for (uint8_t iPtr = 0; iPtr < data.parameters.size; iPtr++)
-    strTx.AppendFormat(":%02x", data.parameters[iPtr]);
-  m_controller->AddLog(CEC_LOG_TRAFFIC, strTx.c_str());
+  m_controller->AddTraffic(data, true);
 }
 
 bool CCECProcessor::SetLogicalAddress(cec_logical_address iLogicalAddress)
 {
   if (m_logicalAddresses.primary != iLogicalAddress)
   {
-    CStdString strLog;
-    strLog.Format("<< setting primary logical address to %1x", iLogicalAddress);
-    m_controller->AddLog(CEC_LOG_NOTICE, strLog.c_str());
+    LIB_CEC_LOG(m_controller, CEC_LOG_NOTICE, "<< setting primary logical address to %1x", iLogicalAddress);
     m_logicalAddresses.primary = iLogicalAddress;
     m_logicalAddresses.Set(iLogicalAddress);
     return SetAckMask(m_logicalAddresses.AckMask());
@@ -474,9 +587,7 @@ bool CCECProcessor::SetPhysicalAddress(uint16_t iPhysicalAddress)
 
 bool CCECProcessor::SwitchMonitoring(bool bEnable)
 {
-  CStdString strLog;
-  strLog.Format("== %s monitoring mode ==", bEnable ? "enabling" : "disabling");
-  m_controller->AddLog(CEC_LOG_NOTICE, strLog.c_str());
+  LIB_CEC_LOG(m_controller, CEC_LOG_NOTICE, "== %s monitoring mode ==", bEnable ? "enabling" : "disabling");
 
   m_bMonitor = bEnable;
   if (bEnable)
@@ -521,20 +632,19 @@ uint8_t CCECProcessor::MuteAudio(void)
 
 CCECBusDevice *CCECProcessor::GetDeviceByPhysicalAddress(uint16_t iPhysicalAddress, bool bRefresh /* = false */) const
 {
-  if (m_busDevices[m_logicalAddresses.primary]->GetPhysicalAddress(false) == iPhysicalAddress)
+  if (m_logicalAddresses.primary != CECDEVICE_UNKNOWN &&
+      m_topology.GetPhysicalAddress(m_logicalAddresses.primary) == iPhysicalAddress)
     return m_busDevices[m_logicalAddresses.primary];
 
-  CCECBusDevice *device = NULL;
-  for (unsigned int iPtr = 0; iPtr < 16; iPtr++)
+  /* the replies update the topology */
+  if (bRefresh)
   {
-    if (m_busDevices[iPtr]->GetPhysicalAddress(bRefresh) == iPhysicalAddress)
-    {
-      device = m_busDevices[iPtr];
-      break;
-    }
+    for (unsigned int iPtr = 0; iPtr < 16; iPtr++)
+      m_busDevices[iPtr]->GetPhysicalAddress(true);
   }
 
-  return device;
+  cec_logical_address iAddress = m_topology.GetLogicalAddress(iPhysicalAddress);
+  return iAddress != CECDEVICE_UNKNOWN ? m_busDevices[iAddress] : NULL;
 }
 
 CCECBusDevice *CCECProcessor::GetDeviceByType(cec_device_type type) const
@@ -582,8 +692,44 @@ cec_power_status CCECProcessor::GetDevicePowerStatus(cec_logical_address iAddres
   return CEC_POWER_STATUS_UNKNOWN;
 }
 
+cec_version CCECProcessor::GetCachedDeviceCecVersion(cec_logical_address iAddress, int64_t *iAgeMs /* = NULL */)
+{
+  if (m_busDevices[iAddress])
+    return m_busDevices[iAddress]->GetCachedCecVersion(iAgeMs);
+  return CEC_VERSION_UNKNOWN;
+}
+
+bool CCECProcessor::GetCachedDeviceMenuLanguage(cec_logical_address iAddress, cec_menu_language *language, int64_t *iAgeMs /* = NULL */)
+{
+  if (m_busDevices[iAddress] && language)
+  {
+    *language = m_busDevices[iAddress]->GetCachedMenuLanguage(iAgeMs);
+    return (strcmp(language->language, "???") != 0);
+  }
+  return false;
+}
+
+uint64_t CCECProcessor::GetCachedDeviceVendorId(cec_logical_address iAddress, int64_t *iAgeMs /* = NULL */)
+{
+  if (m_busDevices[iAddress])
+    return m_busDevices[iAddress]->GetCachedVendorId(iAgeMs);
+  return 0;
+}
+
+cec_power_status CCECProcessor::GetCachedDevicePowerStatus(cec_logical_address iAddress, int64_t *iAgeMs /* = NULL */)
+{
+  if (m_busDevices[iAddress])
+    return m_busDevices[iAddress]->GetCachedPowerStatus(iAgeMs);
+  return CEC_POWER_STATUS_UNKNOWN;
+}
+
 bool CCECProcessor::Transmit(const cec_command &data)
 {
+  /* replies that are sent while handling a frame are queued, so the processor thread doesn't wait for the
+     adapter and can read the next frame. polls are still sent synchronously, because the caller needs the ack */
+  if (data.opcode_set && m_bHandlingCommand && IsCurrentThread())
+    return TransmitAsync(data, &CCECProcessor::ReplyTransmitted, this) != 0;
+
   bool bReturn(false);
   LogOutput(data);
 
@@ -596,32 +742,78 @@ bool CCECProcessor::Transmit(const cec_command &data)
 
 bool CCECProcessor::Transmit(CCECAdapterMessage *output)
 {
-  bool bReturn(false);
-  CLockObject lock(&m_mutex);
+  CLockObject msgLock(&output->mutex);
+  if (!m_communication || !m_communication->Write(output))
+    return false;
+
+  /* the communication thread tracks the adapter's replies and the transmit timeout,
+     and always completes the message, also when the connection is closed */
+  while (!output->is_done())
+    output->condition.Wait(&output->mutex);
+
+  if (output->state == ADAPTER_MESSAGE_STATE_ERROR)
+    m_controller->AddLog(CEC_LOG_ERROR, "command was not sent");
+
+  return output->state == ADAPTER_MESSAGE_STATE_SENT ||
+      output->state == ADAPTER_MESSAGE_STATE_SENT_ACKED;
+}
+
+uint32_t CCECProcessor::TransmitAsync(const cec_command &data, CBCecTransmitDone callback, void *param /* = NULL */)
+{
+  LogOutput(data);
+
+  CCECAdapterMessage *output = new CCECAdapterMessage(data);
+  output->async          = true;
+  output->callback       = callback;
+  output->callback_param = param;
+
+  /* the result is always reported, so always wait for the adapter's reply */
+  if (output->transmit_timeout <= 0)
+    output->transmit_timeout = 1000;
+
   {
-    CLockObject msgLock(&output->mutex);
-    if (!m_communication || !m_communication->Write(output))
-      return bReturn;
-    else
-    {
-      output->condition.Wait(&output->mutex);
-      if (output->state != ADAPTER_MESSAGE_STATE_SENT)
-      {
-        m_controller->AddLog(CEC_LOG_ERROR, "command was not sent");
-        return bReturn;
-      }
-    }
+    CLockObject lock(&m_transmitMutex);
+    if (++m_iLastTicket == 0)
+      ++m_iLastTicket;
+    output->ticket = m_iLastTicket;
+  }
 
-    if (output->transmit_timeout > 0)
-    {
-      if ((bReturn = WaitForTransmitSucceeded(output->size(), output->transmit_timeout)) == false)
-        m_controller->AddLog(CEC_LOG_DEBUG, "did not receive ack");
-    }
-    else
-      bReturn = true;
+  /* the message can be completed and deleted by the processor thread as soon as it's written */
+  uint32_t iTicket(output->ticket);
+  if (!m_communication || !m_communication->Write(output))
+  {
+    delete output;
+    return 0;
   }
 
-  return bReturn;
+  return iTicket;
+}
+
+void CCECProcessor::ReplyTransmitted(void *param, uint32_t iTicket, cec_transmit_status status)
+{
+  CCECProcessor *processor = (CCECProcessor *) param;
+  if (status != CEC_TRANSMIT_STATUS_ACKED)
+    LIB_CEC_LOG(processor->m_controller, CEC_LOG_WARNING, "queued reply %u was not acked (status %d)", iTicket, status);
+}
+
+void CCECProcessor::HandleTransmitCallbacks(void)
+{
+  CCECAdapterMessage *output;
+  while (m_communication && m_communication->GetCompletedMessage(output))
+  {
+    /* the client's callbacks are called from the callback thread, so they can use methods that wait for this
+       thread. libCEC's own callback only logs */
+    if (output->callback == &CCECProcessor::ReplyTransmitted)
+      ReplyTransmitted(output->callback_param, output->ticket, output->transmit_status());
+    else if (output->callback)
+      m_controller->AddTransmitDone(output->callback, output->callback_param, output->ticket, output->transmit_status());
+    delete output;
+  }
+}
+
+bool CCECProcessor::GetTransmitStats(cec_transmit_class transmitClass, cec_transmit_class_stats *stats)
+{
+  return stats && m_communication && m_communication->GetTransmitStats(transmitClass, *stats);
 }
 
 void CCECProcessor::TransmitAbort(cec_logical_address address, cec_opcode opcode, cec_abort_reason reason /* = CEC_ABORT_REASON_UNRECOGNIZED_OPCODE */)
@@ -637,51 +829,6 @@ void CCECProcessor::TransmitAbort(cec_logical_address address, cec_opcode opcode
   Transmit(command);
 }
 
-bool CCECProcessor::WaitForTransmitSucceeded(uint8_t iLength, uint32_t iTimeout /* = 1000 */)
-{
-  bool bError(false);
-  bool bTransmitSucceeded(false);
-  uint8_t iPacketsLeft(iLength / 4);
-
-  int64_t iNow = GetTimeMs();
-  int64_t iTargetTime = iNow + (uint64_t) iTimeout;
-
-  while (!bTransmitSucceeded && !bError && (iTimeout == 0 || iNow < iTargetTime))
-  {
-    CCECAdapterMessage msg;
-
-    if (!m_communication->Read(msg, iTimeout > 0 ? (int32_t)(iTargetTime - iNow) : 1000))
-    {
-      iNow = GetTimeMs();
-      continue;
-    }
-
-    if ((bError = msg.is_error()) == false)
-    {
-      m_controller->AddLog(bError ? CEC_LOG_WARNING : CEC_LOG_DEBUG, msg.ToString());
-
-      switch(msg.message())
-      {
-      case MSGCODE_COMMAND_ACCEPTED:
-        if (iPacketsLeft > 0)
-          iPacketsLeft--;
-        break;
-      case MSGCODE_TRANSMIT_SUCCEEDED:
-        bTransmitSucceeded = (iPacketsLeft == 0);
-        bError = !bTransmitSucceeded;
-        break;
-      default:
-        if (ParseMessage(msg))
-          m_commandBuffer.Push(m_currentframe);
-      }
-
-      iNow = GetTimeMs();
-    }
-  }
-
-  return bTransmitSucceeded && !bError;
-}
-
 bool CCECProcessor::ParseMessage(const CCECAdapterMessage &msg)
 {
   bool bEom = false;
@@ -722,19 +869,157 @@ bool CCECProcessor::ParseMessage(const CCECAdapterMessage &msg)
 
 void CCECProcessor::ParseCommand(cec_command &command)
 {
-  CStdString dataStr;
-  dataStr.Format(">> %1x%1x:%02x", command.initiator, command.destination, command.opcode);
-  for (uint8_t iPtr = 0; iPtr < command.parameters.size; iPtr++)
-    dataStr.AppendFormat(":%02x", (unsigned int)command.parameters[iPtr]);
-  m_controller->AddLog(CEC_LOG_TRAFFIC, dataStr.c_str());
+  /* only the bytes are stored, they're formatted when the log message is read */
+  m_controller->AddTraffic(command, false);
+
+  /* drop frames that are too short before anything else looks at them. misaddressed frames are
+     only logged, because some devices send them anyway and the handlers cope with them */
+  cec_frame_validation validation = CCECOpcodeInfo::Validate(command);
+  if (validation == CEC_FRAME_MISADDRESSED)
+  {
+    LIB_CEC_LOG(m_controller, CEC_LOG_DEBUG, "received a misaddressed frame from %X to %X with opcode %02x", command.initiator, command.destination, command.opcode);
+  }
+  else if (validation == CEC_FRAME_TOO_SHORT)
+  {
+    LIB_CEC_LOG(m_controller, CEC_LOG_DEBUG, "ignoring a too short frame from %X to %X with opcode %02x", command.initiator, command.destination, command.opcode);
+    if (CCECOpcodeInfo::Get(command.opcode)->bFeatureAbort && !m_bMonitor && HasLogicalAddress(command.destination))
+    {
+      m_bHandlingCommand = true;
+      TransmitAbort(command.initiator, command.opcode, CEC_ABORT_REASON_INVALID_OPERAND);
+      m_bHandlingCommand = false;
+    }
+    return;
+  }
+
+  /* learn what we can from all traffic, also when we're only monitoring the bus */
+  if (command.initiator >= CECDEVICE_TV && command.initiator < CECDEVICE_BROADCAST)
+  {
+    m_busDevices[(uint8_t)command.initiator]->LearnFromCommand(command);
+
+    /* the device is active, so start requesting its vendor id if it's unknown */
+    if (!m_timers.IsScheduled(CEC_TIMER_VENDOR_POLL + command.initiator))
+      m_timers.Schedule(CEC_TIMER_VENDOR_POLL + command.initiator, GetTimeMs());
+  }
+
+  /* another device reported our physical address, e.g. because the cached address is outdated */
+  if (!m_bMonitor && command.opcode == CEC_OPCODE_REPORT_PHYSICAL_ADDRESS && command.parameters.size >= 2 &&
+      !m_logicalAddresses[(uint8_t)command.initiator] &&
+      (((uint16_t)command.parameters[0] << 8) | command.parameters[1]) == GetPhysicalAddress())
+  {
+    AddLog(CEC_LOG_NOTICE, "our physical address is used by another device, detecting a new one");
+    m_bCachedPhysicalAddress = false;
+    SetHDMIPort(m_iHDMIPort);
+  }
 
   if (!m_bMonitor && command.initiator >= CECDEVICE_TV && command.initiator <= CECDEVICE_BROADCAST)
+  {
+    m_bHandlingCommand = true;
     m_busDevices[(uint8_t)command.initiator]->HandleCommand(command);
+    m_bHandlingCommand = false;
+  }
+}
+
+bool CCECProcessor::ScanDevices(const cec_logical_addresses &addresses, cec_logical_addresses &present, bool bPrefetch)
+{
+  bool bReturn(true);
+  present.Clear();
+  if (m_logicalAddresses.IsEmpty() || !m_communication)
+    return false;
+
+  /* queue all polls at once. they're sent back-to-back and a poll that isn't acked only
+     costs the time it's on the bus, instead of waiting for each poll in turn */
+  CCECAdapterMessage *polls[15];
+  for (uint8_t iPtr = 0; iPtr < 15; iPtr++)
+  {
+    polls[iPtr] = NULL;
+    if (!addresses[iPtr])
+      continue;
+
+    cec_command command;
+    cec_command::Format(command, m_logicalAddresses.primary, (cec_logical_address) iPtr, CEC_OPCODE_NONE);
+    command.transmit_timeout = CEC_POLL_TIMEOUT;
+
+    polls[iPtr] = new CCECAdapterMessage(command);
+    if (!m_communication->Write(polls[iPtr]))
+    {
+      delete polls[iPtr];
+      polls[iPtr] = NULL;
+      bReturn = false;
+    }
+  }
+
+  for (uint8_t iPtr = 0; iPtr < 15; iPtr++)
+  {
+    if (!polls[iPtr])
+      continue;
+
+    bool bAcked(false);
+    {
+      CLockObject lock(&polls[iPtr]->mutex);
+      while (!polls[iPtr]->is_done())
+        polls[iPtr]->condition.Wait(&polls[iPtr]->mutex);
+      bAcked = polls[iPtr]->state == ADAPTER_MESSAGE_STATE_SENT_ACKED;
+    }
+    delete polls[iPtr];
+
+    m_busDevices[iPtr]->SetDeviceStatus(bAcked ? CEC_DEVICE_STATUS_PRESENT : CEC_DEVICE_STATUS_NOT_PRESENT);
+    if (bAcked)
+    {
+      present.Set((cec_logical_address) iPtr);
+
+      /* queued behind the remaining polls, so they're sent in the same burst */
+      if (bPrefetch)
+        m_busDevices[iPtr]->PrefetchDeviceInfo();
+    }
+  }
+
+  return bReturn;
+}
+
+void CCECProcessor::ScanUnknownDevices(bool bPrefetch /* = false */)
+{
+  cec_logical_addresses unknown;
+  unknown.Clear();
+  for (uint8_t iPtr = 0; iPtr < 15; iPtr++)
+  {
+    if (!m_logicalAddresses[iPtr] && m_busDevices[iPtr]->GetStatus(false) == CEC_DEVICE_STATUS_UNKNOWN)
+      unknown.Set((cec_logical_address) iPtr);
+  }
+
+  if (!unknown.IsEmpty())
+  {
+    cec_logical_addresses present;
+    ScanDevices(unknown, present, bPrefetch);
+  }
+}
+
+bool CCECProcessor::ScanBus(cec_bus_scan_result *result, bool bPrefetch /* = true */)
+{
+  if (!result)
+    return false;
+
+  int64_t iStart = GetTimeMs();
+  result->scanned.Clear();
+  for (uint8_t iPtr = 0; iPtr < 15; iPtr++)
+  {
+    if (!m_logicalAddresses[iPtr])
+      result->scanned.Set((cec_logical_address) iPtr);
+  }
+
+  bool bReturn = ScanDevices(result->scanned, result->present, bPrefetch);
+  result->iDurationMs = (uint32_t) (GetTimeMs() - iStart);
+
+  LIB_CEC_LOG(m_controller, CEC_LOG_DEBUG, "bus scanned in %u ms", result->iDurationMs);
+
+  return bReturn;
 }
 
 cec_logical_addresses CCECProcessor::GetActiveDevices(void)
 {
+  ScanUnknownDevices();
+
   cec_logical_addresses addresses;
+  addresses.Clear();
   for (unsigned int iPtr = 0; iPtr < 15; iPtr++)
   {
     if (m_busDevices[iPtr]->GetStatus() == CEC_DEVICE_STATUS_PRESENT)
@@ -750,6 +1035,8 @@ bool CCECProcessor::IsActiveDevice(cec_logical_address address)
 
 bool CCECProcessor::IsActiveDeviceType(cec_device_type type)
 {
+  ScanUnknownDevices();
+
   for (unsigned int iPtr = 0; iPtr < 15; iPtr++)
   {
     if (m_busDevices[iPtr]->GetType() == type && m_busDevices[iPtr]->GetStatus() == CEC_DEVICE_STATUS_PRESENT)
@@ -769,6 +1056,9 @@ uint16_t CCECProcessor::GetPhysicalAddress(void) const
 void CCECProcessor::SetCurrentButton(cec_user_control_code iButtonCode)
 {
   m_controller->SetCurrentButton(iButtonCode);
+
+  /* release the button when no release is received in time. this is called from the processor thread */
+  m_timers.Schedule(CEC_TIMER_KEYPRESS_TIMEOUT, GetTimeMs() + CEC_BUTTON_TIMEOUT + 1);
 }
 
 void CCECProcessor::AddCommand(const cec_command &command)
@@ -791,12 +1081,66 @@ void CCECProcessor::AddLog(cec_log_level level, const CStdString &strMessage)
   m_controller->AddLog(level, strMessage);
 }
 
+bool CCECProcessor::IsLogLevelEnabled(cec_log_level level) const
+{
+  return m_controller->IsLogLevelEnabled(level);
+}
+
+void CCECProcessor::AddStateChange(const cec_state_change &change)
+{
+  m_controller->AddStateChange(change);
+}
+
+bool CCECProcessor::EnableDeviceCache(const char *strDirectory)
+{
+  return m_deviceCache.SetDirectory(strDirectory);
+}
+
+bool CCECProcessor::LoadDeviceCache(const char *strPort)
+{
+  m_bCachedPhysicalAddress = false;
+  if (!m_deviceCache.Load(strPort))
+    return false;
+
+  const cec_device_cache_data &cache = m_deviceCache.GetData();
+  LIB_CEC_LOG(m_controller, CEC_LOG_DEBUG, "loaded the device cache: logical address %X, physical address %4x, HDMI port %d", cache.iLogicalAddress, cache.iPhysicalAddress, cache.iHDMIPort);
+
+  for (uint8_t iPtr = 0; iPtr < 15; iPtr++)
+    m_busDevices[iPtr]->LoadState(cache.devices[iPtr]);
+  m_bCachedPhysicalAddress = true;
+
+  return true;
+}
+
+bool CCECProcessor::SaveDeviceCache(void)
+{
+  if (!m_deviceCache.IsEnabled() || !m_bStarted)
+    return false;
+
+  cec_device_cache_data cache;
+  CDeviceCache::Clear(cache);
+  cache.iLogicalAddress  = (uint8_t) m_logicalAddresses.primary;
+  cache.iPhysicalAddress = GetPhysicalAddress();
+  cache.iHDMIPort        = m_iHDMIPort;
+
+  const cec_device_cache_data &previous = m_deviceCache.GetData();
+  for (uint8_t iPtr = 0; iPtr < 15; iPtr++)
+  {
+    /* keep the cached state of devices that weren't checked in this session */
+    if (!m_logicalAddresses[iPtr] && m_busDevices[iPtr]->GetStatus(false) == CEC_DEVICE_STATUS_UNKNOWN)
+      cache.devices[iPtr] = previous.devices[iPtr];
+    else
+      m_busDevices[iPtr]->SaveState(cache.devices[iPtr]);
+  }
+
+  m_deviceCache.SetData(cache);
+  return m_deviceCache.Save();
+}
+
 bool CCECProcessor::SetAckMask(uint16_t iMask)
 {
   bool bReturn(false);
-  CStdString strLog;
-  strLog.Format("setting ackmask to %2x", iMask);
-  m_controller->AddLog(CEC_LOG_DEBUG, strLog.c_str());
+  LIB_CEC_LOG(m_controller, CEC_LOG_DEBUG, "setting ackmask to %2x", iMask);
 
   CCECAdapterMessage *output = new CCECAdapterMessage;
 
@@ -34,9 +34,13 @@
 #include <string>
 #include <cectypes.h>
 #include "AdapterCommunication.h"
+#include "DeviceCache.h"
+#include "HDMITopology.h"
 #include "platform/threads.h"
 #include "util/buffer.h"
+#include "util/timerqueue.h"
 #include "util/StdString.h"
+#include <map>
 
 class CSerialPort;
 
@@ -45,6 +49,14 @@ namespace CEC
   class CLibCEC;
   class CAdapterCommunication;
   class CCECBusDevice;
+  class CCECCommandHandler;
+
+  typedef enum cec_processor_timer
+  {
+    CEC_TIMER_KEYPRESS_TIMEOUT = 0,
+    CEC_TIMER_VENDOR_POLL      = 1, /*!< plus the logical address of the device */
+    CEC_TIMER_COUNT            = CEC_TIMER_VENDOR_POLL + 16
+  } cec_processor_timer;
 
   class CCECProcessor : public CThread
   {
@@ -55,6 +67,7 @@ namespace CEC
 
       virtual bool Start(void);
       virtual void *Process(void);
+      virtual bool StopThread(bool bWaitForExit = true);
 
       virtual bool                  IsMonitoring(void) const { return m_bMonitor; }
       virtual CCECBusDevice *       GetDeviceByPhysicalAddress(uint16_t iPhysicalAddress, bool bRefresh = false) const;
@@ -64,13 +77,26 @@ namespace CEC
       virtual const std::string &   GetDeviceName(void) { return m_strDeviceName; }
       virtual uint64_t              GetDeviceVendorId(cec_logical_address iAddress);
       virtual cec_power_status      GetDevicePowerStatus(cec_logical_address iAddress);
+      virtual cec_version           GetCachedDeviceCecVersion(cec_logical_address iAddress, int64_t *iAgeMs = NULL);
+      virtual bool                  GetCachedDeviceMenuLanguage(cec_logical_address iAddress, cec_menu_language *language, int64_t *iAgeMs = NULL);
+      virtual uint64_t              GetCachedDeviceVendorId(cec_logical_address iAddress, int64_t *iAgeMs = NULL);
+      virtual cec_power_status      GetCachedDevicePowerStatus(cec_logical_address iAddress, int64_t *iAgeMs = NULL);
       virtual cec_logical_address   GetLogicalAddress(void) const { return m_logicalAddresses.primary; }
       virtual cec_logical_addresses GetLogicalAddresses(void) const { return m_logicalAddresses; }
       virtual cec_logical_addresses GetActiveDevices(void);
+      virtual bool                  ScanBus(cec_bus_scan_result *result, bool bPrefetch = true);
       virtual bool                  HasLogicalAddress(cec_logical_address address) const { return m_logicalAddresses.IsSet(address); }
       virtual bool                  IsActiveDevice(cec_logical_address address);
       virtual bool                  IsActiveDeviceType(cec_device_type type);
       virtual uint16_t              GetPhysicalAddress(void) const;
+      virtual CHDMITopology &       GetTopology(void) { return m_topology; }
+
+      /*!
+       * @brief Get the command handler for a vendor. All devices of a vendor share one handler, that lives as long as the processor.
+       * @param vendor The vendor of the device.
+       * @return The handler of the vendor, or the default handler when there is no vendor specific one.
+       */
+      virtual CCECCommandHandler *  GetHandler(cec_vendor_id vendor) const;
 
       virtual bool SetActiveView(void);
       virtual bool SetActiveSource(cec_device_type type = CEC_DEVICE_TYPE_RESERVED);
@@ -89,8 +115,18 @@ namespace CEC
       virtual uint8_t VolumeDown(void);
       virtual uint8_t MuteAudio(void);
 
+      /*!
+       * @brief Send a frame and wait until it was sent. Frames that are sent by a command handler on the processor
+       *        thread are queued instead, and a queued frame that isn't acked is logged when it completes.
+       * @param data The frame to send.
+       * @return True when the frame was sent, or when it was queued while handling a command. A handler can't use
+       *         the return value to find out whether its reply was acked.
+       */
       virtual bool Transmit(const cec_command &data);
       virtual bool Transmit(CCECAdapterMessage *output);
+      virtual uint32_t TransmitAsync(const cec_command &data, CBCecTransmitDone callback, void *param = NULL);
+      virtual void HandleTransmitCallbacks(void);
+      virtual bool GetTransmitStats(cec_transmit_class transmitClass, cec_transmit_class_stats *stats);
       virtual void TransmitAbort(cec_logical_address address, cec_opcode opcode, cec_abort_reason reason = CEC_ABORT_REASON_UNRECOGNIZED_OPCODE);
 
       virtual void SetCurrentButton(cec_user_control_code iButtonCode);
@@ -98,22 +134,45 @@ namespace CEC
       virtual void AddKey(cec_keypress &key);
       virtual void AddKey(void);
       virtual void AddLog(cec_log_level level, const CStdString &strMessage);
+      bool IsLogLevelEnabled(cec_log_level level) const;
+      virtual void AddStateChange(const cec_state_change &change);
 
       virtual bool FindLogicalAddresses(void);
+
+      /*!
+       * @name Device cache
+       * @brief Start with the bus configuration of the previous session. The cache is loaded before Start() and
+       *        saved after the processor thread stopped.
+       */
+      //@{
+      virtual bool EnableDeviceCache(const char *strDirectory);
+      virtual bool LoadDeviceCache(const char *strPort);
+      virtual bool SaveDeviceCache(void);
+      //@}
       virtual bool SetAckMask(uint16_t iMask);
 
       CCECBusDevice *m_busDevices[16];
 
   private:
+      void RegisterHandlers(void);
+      void RegisterHandler(CCECCommandHandler *handler);
       bool CheckPhysicalAddress(uint16_t iPhysicalAddress);
+      bool ScanDevices(const cec_logical_addresses &addresses, cec_logical_addresses &present, bool bPrefetch);
+      void ScanUnknownDevices(bool bPrefetch = false);
       bool TryLogicalAddress(cec_logical_address address);
       bool FindLogicalAddressRecordingDevice(void);
       bool FindLogicalAddressTuner(void);
       bool FindLogicalAddressPlaybackDevice(void);
       bool FindLogicalAddressAudioSystem(void);
 
+      /*!
+       * @brief Run the timers that expired.
+       * @return The time in ms until the next timer expires.
+       */
+      uint32_t RunTimers(void);
+
+      static void ReplyTransmitted(void *param, uint32_t iTicket, cec_transmit_status status);
       void LogOutput(const cec_command &data);
-      bool WaitForTransmitSucceeded(uint8_t iLength, uint32_t iTimeout = 1000);
       bool ParseMessage(const CCECAdapterMessage &msg);
       void ParseCommand(cec_command &command);
 
@@ -128,6 +187,13 @@ namespace CEC
       CAdapterCommunication* m_communication;
       CLibCEC*               m_controller;
       bool                   m_bMonitor;
-      CecBuffer<cec_command> m_commandBuffer;
+      CMutex                 m_transmitMutex;
+      uint32_t               m_iLastTicket;
+      CDeviceCache           m_deviceCache;
+      bool                   m_bCachedPhysicalAddress;
+      bool                   m_bHandlingCommand; /* only used by the processor thread, Transmit() queues replies when set */
+      CHDMITopology          m_topology;
+      std::map<cec_vendor_id, CCECCommandHandler *> m_handlers;
+      CecTimerQueue          m_timers; /* only used by the processor thread */
   };
 };
@@ -0,0 +1,272 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "CallbackDispatcher.h"
+
+using namespace std;
+using namespace CEC;
+
+CCallbackDispatcher::CCallbackDispatcher(CecLogBuffer *logBuffer) :
+    m_logBuffer(logBuffer),
+    m_param(NULL),
+    m_iDropped(0),
+    m_bLogPending(false)
+{
+  m_callbacks.Clear();
+}
+
+CCallbackDispatcher::~CCallbackDispatcher(void)
+{
+  StopThread();
+}
+
+bool CCallbackDispatcher::SetCallbacks(const cec_callbacks *callbacks, void *param)
+{
+  CLockObject lock(&m_mutex);
+  if (callbacks)
+    m_callbacks = *callbacks;
+  else
+    m_callbacks.Clear();
+  m_param = param;
+  Clear();
+  lock.Leave();
+
+  return IsRunning() || CreateThread();
+}
+
+bool CCallbackDispatcher::AddLog(void)
+{
+  /* while a log event is waiting, the thread hasn't started to drain the log buffer yet and will pass this message
+     as well. the mutex is only taken when there is none */
+  AtomicBarrier();
+  if (m_bLogPending)
+    return true;
+
+  CLockObject lock(&m_mutex);
+  if (!m_callbacks.CBLogMessage)
+    return false;
+
+  /* the log buffer limits the number of waiting messages, so one event is queued for all of them */
+  if (!m_bLogPending)
+  {
+    m_bLogPending = true;
+    m_events.push(CEC_CALLBACK_LOG_MESSAGE);
+    m_condition.Signal();
+  }
+  return true;
+}
+
+bool CCallbackDispatcher::AddKey(const cec_keypress &key)
+{
+  CLockObject lock(&m_mutex);
+  if (!m_callbacks.CBKeyPress)
+    return false;
+
+  if (Queue(CEC_CALLBACK_KEY_PRESS, m_keyPresses.size()))
+    m_keyPresses.push(key);
+  return true;
+}
+
+bool CCallbackDispatcher::AddCommand(const cec_command &command)
+{
+  CLockObject lock(&m_mutex);
+  if (!m_callbacks.CBCommand)
+    return false;
+
+  if (Queue(CEC_CALLBACK_COMMAND, m_commands.size()))
+    m_commands.push(command);
+  return true;
+}
+
+bool CCallbackDispatcher::AddStateChange(const cec_state_change &change)
+{
+  CLockObject lock(&m_mutex);
+  if (!m_callbacks.CBStateChange)
+    return false;
+
+  if (Queue(CEC_CALLBACK_STATE_CHANGE, m_stateChanges.size()))
+    m_stateChanges.push(change);
+  return true;
+}
+
+void CCallbackDispatcher::AddTransmitDone(CBCecTransmitDone callback, void *param, uint32_t iTicket, cec_transmit_status status)
+{
+  if (!IsRunning() && !IsStopped())
+    CreateThread();
+
+  CLockObject lock(&m_mutex);
+  if (IsStopped() || !IsRunning())
+  {
+    /* the thread was stopped because libCEC is being destroyed, or could not be started */
+    lock.Leave();
+    callback(param, iTicket, status);
+    return;
+  }
+
+  cec_transmit_done done;
+  done.callback = callback;
+  done.param    = param;
+  done.iTicket  = iTicket;
+  done.status   = status;
+
+  /* not limited by CEC_CALLBACK_QUEUE_SIZE: each transmission completes once, and the transmit queues limit how
+     many there are */
+  m_transmits.push(done);
+  m_events.push(CEC_CALLBACK_TRANSMIT_DONE);
+  m_condition.Signal();
+}
+
+bool CCallbackDispatcher::Queue(cec_callback_type type, size_t iQueued)
+{
+  if (iQueued >= CEC_CALLBACK_QUEUE_SIZE)
+  {
+    ++m_iDropped;
+    return false;
+  }
+
+  m_events.push(type);
+  m_condition.Signal();
+  return true;
+}
+
+void CCallbackDispatcher::Clear(void)
+{
+  m_bLogPending = false;
+
+  /* completed transmissions are kept: their callbacks were passed to TransmitAsync() */
+  std::queue<cec_callback_type> events;
+  for (size_t iPtr = 0; iPtr < m_transmits.size(); iPtr++)
+    events.push(CEC_CALLBACK_TRANSMIT_DONE);
+  m_events = events;
+
+  while (!m_keyPresses.empty())
+    m_keyPresses.pop();
+  while (!m_commands.empty())
+    m_commands.pop();
+  while (!m_stateChanges.empty())
+    m_stateChanges.pop();
+}
+
+bool CCallbackDispatcher::StopThread(bool bWaitForExit /* = true */)
+{
+  /* set the stop flag while holding the mutex, so Process() can't miss the wake up between checking it and waiting */
+  CLockObject lock(&m_mutex);
+  CThread::StopThread(false);
+  m_condition.Broadcast();
+  lock.Leave();
+
+  return CThread::StopThread(bWaitForExit);
+}
+
+void *CCallbackDispatcher::Process(void)
+{
+  while (!IsStopped())
+  {
+    CLockObject lock(&m_mutex);
+    if (m_events.empty())
+    {
+      if (!IsStopped())
+        m_condition.Wait(&m_mutex);
+      continue;
+    }
+
+    /* copy the event and the callbacks, and call the client without holding the mutex */
+    cec_callback_type type = m_events.front();
+    m_events.pop();
+    cec_callbacks callbacks = m_callbacks;
+    void *param = m_param;
+
+    switch (type)
+    {
+    case CEC_CALLBACK_LOG_MESSAGE:
+      {
+        /* clear the flag before draining, so a message that is added after the last Pop() queues a new event */
+        m_bLogPending = false;
+        AtomicBarrier();
+        lock.Leave();
+        cec_log_message message;
+        while (callbacks.CBLogMessage && m_logBuffer->Pop(message))
+          callbacks.CBLogMessage(param, message);
+      }
+      break;
+    case CEC_CALLBACK_KEY_PRESS:
+      {
+        cec_keypress key = m_keyPresses.front();
+        m_keyPresses.pop();
+        lock.Leave();
+        if (callbacks.CBKeyPress)
+          callbacks.CBKeyPress(param, key);
+      }
+      break;
+    case CEC_CALLBACK_COMMAND:
+      {
+        cec_command command = m_commands.front();
+        m_commands.pop();
+        lock.Leave();
+        if (callbacks.CBCommand)
+          callbacks.CBCommand(param, command);
+      }
+      break;
+    case CEC_CALLBACK_STATE_CHANGE:
+      {
+        cec_state_change change = m_stateChanges.front();
+        m_stateChanges.pop();
+        lock.Leave();
+        if (callbacks.CBStateChange)
+          callbacks.CBStateChange(param, change);
+      }
+      break;
+    case CEC_CALLBACK_TRANSMIT_DONE:
+      {
+        cec_transmit_done done = m_transmits.front();
+        m_transmits.pop();
+        lock.Leave();
+        done.callback(done.param, done.iTicket, done.status);
+      }
+      break;
+    }
+  }
+
+  /* the client waits for the completion of every transmission, also when the thread is stopped */
+  CLockObject lock(&m_mutex);
+  while (!m_transmits.empty())
+  {
+    cec_transmit_done done = m_transmits.front();
+    m_transmits.pop();
+    lock.Leave();
+    done.callback(done.param, done.iTicket, done.status);
+    lock.Lock();
+  }
+  Clear();
+
+  return NULL;
+}
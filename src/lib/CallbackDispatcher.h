@@ -0,0 +1,128 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include <cectypes.h>
+#include <queue>
+#include "platform/atomics.h"
+#include "platform/threads.h"
+#include "util/logbuffer.h"
+
+namespace CEC
+{
+  #define CEC_CALLBACK_QUEUE_SIZE 1000
+
+  /*!
+   * @brief Passes log messages, keypresses, commands, state changes and completed transmissions to the callbacks of
+   *        the client from a thread of its own, so the processor thread never waits for the client, and the client
+   *        can call blocking methods from a callback. Events are passed in the order in which
+   *        they were added. An event is dropped when there already are CEC_CALLBACK_QUEUE_SIZE events of its type
+   *        waiting. Log messages aren't copied: they are read from the log buffer when they're passed, and at most
+   *        one log event is waiting for all of them.
+   */
+  class CCallbackDispatcher : public CThread
+  {
+  public:
+    CCallbackDispatcher(CecLogBuffer *logBuffer);
+    virtual ~CCallbackDispatcher(void);
+
+    /*!
+     * @brief Change the callbacks and start the thread if it isn't running yet. Waiting events are dropped.
+     * @param callbacks The new callbacks or NULL to disable all callbacks.
+     * @param param The parameter to pass to each callback.
+     * @return True when the callbacks were set, false when the thread could not be started.
+     */
+    virtual bool SetCallbacks(const cec_callbacks *callbacks, void *param);
+
+    /*!
+     * @name Events
+     * @brief Queue an event for the callback thread. AddLog() is called after the message was added to the log buffer.
+     * @return True when there is a callback for this type of event, false when the caller should buffer it.
+     */
+    //@{
+    virtual bool AddLog(void);
+    virtual bool AddKey(const cec_keypress &key);
+    virtual bool AddCommand(const cec_command &command);
+    virtual bool AddStateChange(const cec_state_change &change);
+    //@}
+
+    /*!
+     * @brief Queue the completion of a transmission that was queued with TransmitAsync(). Starts the thread if it
+     *        isn't running yet. These are never dropped: the callback is called directly when the thread was stopped,
+     *        and completions that are waiting are passed before the thread exits.
+     * @param callback The callback that was passed to TransmitAsync().
+     * @param param The parameter that was passed to TransmitAsync().
+     * @param iTicket The ticket of the transmission.
+     * @param status The result of the transmission.
+     */
+    virtual void AddTransmitDone(CBCecTransmitDone callback, void *param, uint32_t iTicket, cec_transmit_status status);
+
+    virtual uint64_t GetDropped(void) const { return m_iDropped; }
+
+    virtual bool StopThread(bool bWaitForExit = true);
+    virtual void *Process(void);
+
+  private:
+    typedef enum cec_callback_type
+    {
+      CEC_CALLBACK_LOG_MESSAGE = 0,
+      CEC_CALLBACK_KEY_PRESS,
+      CEC_CALLBACK_COMMAND,
+      CEC_CALLBACK_STATE_CHANGE,
+      CEC_CALLBACK_TRANSMIT_DONE
+    } cec_callback_type;
+
+    typedef struct cec_transmit_done
+    {
+      CBCecTransmitDone   callback;
+      void *              param;
+      uint32_t            iTicket;
+      cec_transmit_status status;
+    } cec_transmit_done;
+
+    bool Queue(cec_callback_type type, size_t iQueued);
+    void Clear(void);
+
+    CecLogBuffer *                m_logBuffer;
+    CMutex                        m_mutex;
+    CCondition                    m_condition;
+    cec_callbacks                 m_callbacks;
+    void *                        m_param;
+    uint64_t                      m_iDropped;
+    volatile bool                 m_bLogPending;
+    std::queue<cec_callback_type> m_events;
+    std::queue<cec_keypress>      m_keyPresses;
+    std::queue<cec_command>       m_commands;
+    std::queue<cec_state_change>  m_stateChanges;
+    std::queue<cec_transmit_done> m_transmits;
+  };
+};
@@ -0,0 +1,139 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "DeviceCache.h"
+#include <stdio.h>
+#include <string.h>
+
+using namespace CEC;
+
+CDeviceCache::CDeviceCache(void) :
+    m_bLoaded(false)
+{
+  Clear(m_data);
+}
+
+bool CDeviceCache::SetDirectory(const char *strDirectory)
+{
+  m_strDirectory = strDirectory ? strDirectory : "";
+  m_strFile.clear();
+  m_bLoaded = false;
+  return IsEnabled();
+}
+
+bool CDeviceCache::Load(const char *strPort)
+{
+  m_bLoaded = false;
+  Clear(m_data);
+  if (!IsEnabled() || !strPort)
+    return false;
+
+  /* the file is keyed by the path of the adapter */
+  CStdString strName(strPort);
+  for (unsigned int iPtr = 0; iPtr < strName.length(); iPtr++)
+  {
+    char c = strName[iPtr];
+    if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '.'))
+      strName[iPtr] = '_';
+  }
+  m_strFile.Format("%s/libcec-%s.cache", m_strDirectory.c_str(), strName.c_str());
+
+  FILE *file = fopen(m_strFile.c_str(), "rb");
+  if (!file)
+    return false;
+
+  cec_device_cache_data data;
+  bool bRead = fread(&data, sizeof(data), 1, file) == 1;
+  fclose(file);
+
+  if (!bRead ||
+      data.iMagic != CEC_DEVICE_CACHE_MAGIC ||
+      data.iVersion != CEC_DEVICE_CACHE_VERSION ||
+      data.iSize != sizeof(cec_device_cache_data))
+    return false;
+
+  for (unsigned int iPtr = 0; iPtr < 16; iPtr++)
+    data.devices[iPtr].strOSDName[CEC_DEVICE_CACHE_OSD_NAME_SIZE - 1] = 0;
+
+  m_data = data;
+  m_bLoaded = true;
+  return true;
+}
+
+bool CDeviceCache::Save(void)
+{
+  if (!IsEnabled() || m_strFile.empty())
+    return false;
+
+  /* write a new file and replace the old one, so a reader never sees a partial file */
+  CStdString strTmpFile;
+  strTmpFile.Format("%s.tmp", m_strFile.c_str());
+
+  FILE *file = fopen(strTmpFile.c_str(), "wb");
+  if (!file)
+    return false;
+
+  bool bWritten = fwrite(&m_data, sizeof(m_data), 1, file) == 1;
+  bWritten &= fclose(file) == 0;
+
+#if defined(__WINDOWS__)
+  if (bWritten)
+    remove(m_strFile.c_str());
+#endif
+  if (!bWritten || rename(strTmpFile.c_str(), m_strFile.c_str()) != 0)
+  {
+    remove(strTmpFile.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+void CDeviceCache::SetData(const cec_device_cache_data &data)
+{
+  m_data          = data;
+  m_data.iMagic   = CEC_DEVICE_CACHE_MAGIC;
+  m_data.iVersion = CEC_DEVICE_CACHE_VERSION;
+  m_data.iSize    = sizeof(cec_device_cache_data);
+}
+
+void CDeviceCache::Clear(cec_device_cache_data &data)
+{
+  memset(&data, 0, sizeof(data));
+  data.iMagic           = CEC_DEVICE_CACHE_MAGIC;
+  data.iVersion         = CEC_DEVICE_CACHE_VERSION;
+  data.iSize            = sizeof(cec_device_cache_data);
+  data.iPhysicalAddress = 0xFFFF;
+  data.iLogicalAddress  = (uint8_t)CECDEVICE_UNKNOWN;
+  for (unsigned int iPtr = 0; iPtr < 16; iPtr++)
+    data.devices[iPtr].iPhysicalAddress = 0xFFFF;
+}
@@ -0,0 +1,113 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include <cectypes.h>
+#include "util/StdString.h"
+
+namespace CEC
+{
+  #define CEC_DEVICE_CACHE_MAGIC         0x44434543 /* "CECD" when written on a little endian host */
+  #define CEC_DEVICE_CACHE_VERSION       1
+  #define CEC_DEVICE_CACHE_OSD_NAME_SIZE 16
+
+  /*!
+   * @brief The last known state of one device on the bus.
+   */
+  typedef struct cec_device_cache_entry
+  {
+    uint32_t iVendorId;
+    uint16_t iPhysicalAddress;
+    uint8_t  iPresent;
+    uint8_t  iCecVersion;
+    char     strOSDName[CEC_DEVICE_CACHE_OSD_NAME_SIZE];
+  } cec_device_cache_entry;
+
+  /*!
+   * @brief The contents of a device cache file. All fields have a fixed size and are naturally aligned, so the
+   *        file is written as is and can be mapped directly. A file with another magic, version or size is ignored.
+   */
+  typedef struct cec_device_cache_data
+  {
+    uint32_t               iMagic;
+    uint16_t               iVersion;
+    uint16_t               iSize;
+    uint16_t               iPhysicalAddress;
+    uint8_t                iLogicalAddress;
+    uint8_t                iHDMIPort;
+    cec_device_cache_entry devices[16];
+  } cec_device_cache_data;
+
+  /*!
+   * @brief Stores the bus configuration when the connection is closed, so the next start can use it instead of
+   *        detecting everything again. There is one file per adapter in the cache directory.
+   */
+  class CDeviceCache
+  {
+  public:
+    CDeviceCache(void);
+    virtual ~CDeviceCache(void) {};
+
+    /*!
+     * @brief Enable or disable the cache.
+     * @param strDirectory The directory to store the cache files in, or NULL to disable the cache.
+     * @return True when the cache is enabled, false otherwise.
+     */
+    virtual bool SetDirectory(const char *strDirectory);
+    virtual bool IsEnabled(void) const { return !m_strDirectory.empty(); }
+
+    /*!
+     * @brief Load the cache file of an adapter.
+     * @param strPort The path of the adapter.
+     * @return True when a valid cache file was loaded, false otherwise.
+     */
+    virtual bool Load(const char *strPort);
+
+    /*!
+     * @brief Write the cache file of the adapter that was passed to Load().
+     * @return True when the file was written, false otherwise.
+     */
+    virtual bool Save(void);
+
+    virtual bool                         IsLoaded(void) const { return m_bLoaded; }
+    virtual const cec_device_cache_data &GetData(void) const { return m_data; }
+    virtual void                         SetData(const cec_device_cache_data &data);
+
+    static void Clear(cec_device_cache_data &data);
+
+  private:
+    CStdString            m_strDirectory;
+    CStdString            m_strFile;
+    bool                  m_bLoaded;
+    cec_device_cache_data m_data;
+  };
+};
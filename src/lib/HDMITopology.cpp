@@ -0,0 +1,291 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "HDMITopology.h"
+#include <string.h>
+
+using namespace CEC;
+
+CHDMITopology::CHDMITopology(void)
+{
+  memset(m_nodes, 0, sizeof(m_nodes));
+  for (unsigned int iPtr = 0; iPtr < CEC_TOPOLOGY_MAX_NODES; iPtr++)
+    m_nodes[iPtr].iLogicalAddress = CECDEVICE_UNKNOWN;
+  m_nodes[0].bUsed = true;
+
+  for (unsigned int iPtr = 0; iPtr < 16; iPtr++)
+    m_addresses[iPtr] = CEC_INVALID_PHYSICAL_ADDRESS;
+}
+
+void CHDMITopology::SetPhysicalAddress(cec_logical_address iAddress, uint16_t iPhysicalAddress)
+{
+  if (iAddress < CECDEVICE_TV || iAddress > CECDEVICE_BROADCAST)
+    return;
+
+  CLockObject lock(&m_mutex);
+  uint16_t iOldAddress = m_addresses[iAddress];
+  if (iOldAddress == iPhysicalAddress)
+    return;
+  m_addresses[iAddress] = iPhysicalAddress;
+
+  /* unlink the old address. another device that still reports it takes its place */
+  int iNode = FindNode(iOldAddress);
+  if (iNode >= 0 && m_nodes[iNode].iLogicalAddress == iAddress)
+  {
+    m_nodes[iNode].iLogicalAddress = CECDEVICE_UNKNOWN;
+    for (uint8_t iPtr = 0; iPtr < 16; iPtr++)
+    {
+      if (m_addresses[iPtr] == iOldAddress)
+      {
+        m_nodes[iNode].iLogicalAddress = (int8_t)iPtr;
+        break;
+      }
+    }
+    RemoveNode(iNode);
+  }
+
+  iNode = CreateNode(iPhysicalAddress);
+  if (iNode >= 0)
+    m_nodes[iNode].iLogicalAddress = (int8_t)iAddress;
+}
+
+uint16_t CHDMITopology::GetPhysicalAddress(cec_logical_address iAddress) const
+{
+  if (iAddress < CECDEVICE_TV || iAddress > CECDEVICE_BROADCAST)
+    return CEC_INVALID_PHYSICAL_ADDRESS;
+
+  CLockObject lock(&m_mutex);
+  return m_addresses[iAddress];
+}
+
+cec_logical_address CHDMITopology::GetLogicalAddress(uint16_t iPhysicalAddress) const
+{
+  CLockObject lock(&m_mutex);
+  int iNode = FindNode(iPhysicalAddress);
+  return iNode >= 0 ? (cec_logical_address) m_nodes[iNode].iLogicalAddress : CECDEVICE_UNKNOWN;
+}
+
+cec_logical_address CHDMITopology::GetParentDevice(uint16_t iPhysicalAddress) const
+{
+  if (!IsValid(iPhysicalAddress))
+    return CECDEVICE_UNKNOWN;
+
+  CLockObject lock(&m_mutex);
+  while (iPhysicalAddress != 0)
+  {
+    iPhysicalAddress = GetParent(iPhysicalAddress);
+    int iNode = FindNode(iPhysicalAddress);
+    if (iNode >= 0 && m_nodes[iNode].iLogicalAddress != CECDEVICE_UNKNOWN)
+      return (cec_logical_address) m_nodes[iNode].iLogicalAddress;
+  }
+
+  return CECDEVICE_UNKNOWN;
+}
+
+cec_logical_addresses CHDMITopology::GetChildDevices(uint16_t iPhysicalAddress) const
+{
+  cec_logical_addresses children;
+  children.Clear();
+
+  CLockObject lock(&m_mutex);
+  int iNode = FindNode(iPhysicalAddress);
+  if (iNode >= 0)
+  {
+    for (uint8_t iPort = 1; iPort < 16; iPort++)
+    {
+      uint8_t iChild = m_nodes[iNode].children[iPort];
+      if (iChild != 0 && m_nodes[iChild].iLogicalAddress != CECDEVICE_UNKNOWN)
+        children.Set((cec_logical_address) m_nodes[iChild].iLogicalAddress);
+    }
+  }
+
+  return children;
+}
+
+uint8_t CHDMITopology::GetPath(uint16_t iFrom, uint16_t iTo, uint16_t *path, uint8_t iMaxLength)
+{
+  if (!IsValid(iFrom) || !IsValid(iTo) || iMaxLength == 0)
+    return 0;
+
+  /* walk up from the source until we reach an ancestor of the sink */
+  uint8_t iLength(0);
+  uint16_t iCommon(iFrom);
+  while (!IsBelow(iCommon, iTo))
+  {
+    if (iLength < iMaxLength)
+      path[iLength++] = iCommon;
+    iCommon = GetParent(iCommon);
+  }
+
+  /* and down from there to the sink */
+  uint8_t iDown = GetDepth(iTo) - GetDepth(iCommon) + 1;
+  for (uint8_t iPtr = 0; iPtr < iDown; iPtr++)
+  {
+    if (iLength + iDown - iPtr - 1 < iMaxLength)
+      path[iLength + iDown - iPtr - 1] = iTo;
+    iTo = GetParent(iTo);
+  }
+  iLength += iDown;
+
+  return iLength > iMaxLength ? iMaxLength : iLength;
+}
+
+bool CHDMITopology::IsValid(uint16_t iPhysicalAddress)
+{
+  if (iPhysicalAddress == CEC_INVALID_PHYSICAL_ADDRESS)
+    return false;
+
+  /* once a level is 0, all levels below it must be 0 too */
+  bool bEnd(false);
+  for (int iLevel = 0; iLevel < 4; iLevel++)
+  {
+    uint8_t iPort = (iPhysicalAddress >> (12 - 4 * iLevel)) & 0xF;
+    if (iPort == 0)
+      bEnd = true;
+    else if (bEnd)
+      return false;
+  }
+  return true;
+}
+
+uint8_t CHDMITopology::GetDepth(uint16_t iPhysicalAddress)
+{
+  uint8_t iDepth(0);
+  while (iDepth < 4 && ((iPhysicalAddress >> (12 - 4 * iDepth)) & 0xF) != 0)
+    iDepth++;
+  return iDepth;
+}
+
+uint16_t CHDMITopology::GetParent(uint16_t iPhysicalAddress)
+{
+  uint8_t iDepth = GetDepth(iPhysicalAddress);
+  if (iDepth == 0)
+    return 0;
+  return iPhysicalAddress & ~(0xF << (16 - 4 * iDepth));
+}
+
+uint8_t CHDMITopology::GetPort(uint16_t iPhysicalAddress)
+{
+  uint8_t iDepth = GetDepth(iPhysicalAddress);
+  if (iDepth == 0)
+    return 0;
+  return (iPhysicalAddress >> (16 - 4 * iDepth)) & 0xF;
+}
+
+uint16_t CHDMITopology::GetChild(uint16_t iPhysicalAddress, uint8_t iPort)
+{
+  uint8_t iDepth = GetDepth(iPhysicalAddress);
+  if (iDepth >= 4 || iPort == 0 || iPort > 0xF)
+    return CEC_INVALID_PHYSICAL_ADDRESS;
+  return iPhysicalAddress | (iPort << (12 - 4 * iDepth));
+}
+
+bool CHDMITopology::IsBelow(uint16_t iAncestor, uint16_t iPhysicalAddress)
+{
+  uint8_t iDepth = GetDepth(iAncestor);
+  if (GetDepth(iPhysicalAddress) < iDepth)
+    return false;
+
+  uint16_t iMask = iDepth == 0 ? 0 : (uint16_t)(0xFFFF << (16 - 4 * iDepth));
+  return (iPhysicalAddress & iMask) == iAncestor;
+}
+
+int CHDMITopology::FindNode(uint16_t iPhysicalAddress) const
+{
+  if (!IsValid(iPhysicalAddress))
+    return -1;
+
+  int iNode(0);
+  uint8_t iDepth = GetDepth(iPhysicalAddress);
+  for (uint8_t iLevel = 0; iLevel < iDepth && iNode >= 0; iLevel++)
+  {
+    uint8_t iChild = m_nodes[iNode].children[(iPhysicalAddress >> (12 - 4 * iLevel)) & 0xF];
+    iNode = iChild != 0 ? iChild : -1;
+  }
+
+  return iNode;
+}
+
+int CHDMITopology::CreateNode(uint16_t iPhysicalAddress)
+{
+  if (!IsValid(iPhysicalAddress))
+    return -1;
+
+  int iNode(0);
+  uint8_t iDepth = GetDepth(iPhysicalAddress);
+  for (uint8_t iLevel = 0; iLevel < iDepth; iLevel++)
+  {
+    uint8_t iPort = (iPhysicalAddress >> (12 - 4 * iLevel)) & 0xF;
+    if (m_nodes[iNode].children[iPort] == 0)
+    {
+      uint8_t iFree(1);
+      while (iFree < CEC_TOPOLOGY_MAX_NODES && m_nodes[iFree].bUsed)
+        iFree++;
+      if (iFree == CEC_TOPOLOGY_MAX_NODES)
+      {
+        /* can't happen while every logical address holds at most 4 nodes, but don't leave empty nodes behind */
+        RemoveNode(iNode);
+        return -1;
+      }
+
+      memset(&m_nodes[iFree], 0, sizeof(cec_topology_node));
+      m_nodes[iFree].bUsed           = true;
+      m_nodes[iFree].iLogicalAddress = CECDEVICE_UNKNOWN;
+      m_nodes[iFree].iParent         = (uint8_t)iNode;
+      m_nodes[iNode].children[iPort] = iFree;
+      m_nodes[iNode].iChildCount++;
+    }
+    iNode = m_nodes[iNode].children[iPort];
+  }
+
+  return iNode;
+}
+
+void CHDMITopology::RemoveNode(int iNode)
+{
+  /* remove the node and its parents, as long as no device uses them */
+  while (iNode > 0 && m_nodes[iNode].iLogicalAddress == CECDEVICE_UNKNOWN && m_nodes[iNode].iChildCount == 0)
+  {
+    int iParent = m_nodes[iNode].iParent;
+    for (uint8_t iPort = 1; iPort < 16; iPort++)
+    {
+      if (m_nodes[iParent].children[iPort] == iNode)
+      {
+        m_nodes[iParent].children[iPort] = 0;
+        m_nodes[iParent].iChildCount--;
+        break;
+      }
+    }
+    m_nodes[iNode].bUsed = false;
+    iNode = iParent;
+  }
+}
@@ -0,0 +1,146 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include <cectypes.h>
+#include "platform/threads.h"
+
+namespace CEC
+{
+  #define CEC_INVALID_PHYSICAL_ADDRESS 0xFFFF
+
+  /* the root, plus one node for every level of the address of every logical address */
+  #define CEC_TOPOLOGY_MAX_NODES       (1 + 4 * 16)
+
+  /* the maximum number of hops in a path: four levels up to the root, the root and four levels down */
+  #define CEC_TOPOLOGY_MAX_PATH        9
+
+  typedef struct cec_topology_node
+  {
+    bool     bUsed;
+    int8_t   iLogicalAddress; /* the device with this address, or CECDEVICE_UNKNOWN */
+    uint8_t  iParent;
+    uint8_t  iChildCount;
+    uint8_t  children[16];    /* the node for every port, or 0. port 0 is not a valid port */
+  } cec_topology_node;
+
+  /*!
+   * @brief Index of the HDMI tree, built from the physical addresses that devices report.
+   *
+   * Every level of a physical address is a port on the device one level up, e.g. 1.2.0.0 is
+   * connected to port 2 of 1.0.0.0, which is connected to port 1 of the TV. The index is a tree
+   * with one node per level, so a lookup by physical address takes at most four steps and
+   * never touches the bus. It's updated every time a device reports a new address.
+   */
+  class CHDMITopology
+  {
+  public:
+    CHDMITopology(void);
+    virtual ~CHDMITopology(void) {};
+
+    /*!
+     * @brief Update the physical address of a device.
+     * @param iAddress The logical address of the device.
+     * @param iPhysicalAddress The new physical address, or CEC_INVALID_PHYSICAL_ADDRESS to remove the device.
+     */
+    void SetPhysicalAddress(cec_logical_address iAddress, uint16_t iPhysicalAddress);
+
+    /*!
+     * @return The physical address of the given device, or CEC_INVALID_PHYSICAL_ADDRESS when it isn't known.
+     */
+    uint16_t GetPhysicalAddress(cec_logical_address iAddress) const;
+
+    /*!
+     * @return The logical address of the device with the given physical address, or CECDEVICE_UNKNOWN when it isn't known.
+     */
+    cec_logical_address GetLogicalAddress(uint16_t iPhysicalAddress) const;
+
+    /*!
+     * @return The nearest known device upstream of the given physical address, or CECDEVICE_UNKNOWN when there is none.
+     */
+    cec_logical_address GetParentDevice(uint16_t iPhysicalAddress) const;
+
+    /*!
+     * @return The known devices that are connected directly to a port of the given physical address.
+     */
+    cec_logical_addresses GetChildDevices(uint16_t iPhysicalAddress) const;
+
+    /*!
+     * @brief Get the route that a stream takes between two physical addresses.
+     * @param iFrom The physical address of the source.
+     * @param iTo The physical address of the sink.
+     * @param path Filled with the physical addresses of all hops, including iFrom and iTo.
+     * @param iMaxLength The size of path. CEC_TOPOLOGY_MAX_PATH is always enough.
+     * @return The number of hops in the path, or 0 when one of the addresses isn't valid.
+     */
+    static uint8_t GetPath(uint16_t iFrom, uint16_t iTo, uint16_t *path, uint8_t iMaxLength);
+
+    /*!
+     * @return True when this is a physical address that can exist in an HDMI tree, false otherwise.
+     */
+    static bool IsValid(uint16_t iPhysicalAddress);
+
+    /*!
+     * @return The number of levels below the root (0.0.0.0) of a valid physical address.
+     */
+    static uint8_t GetDepth(uint16_t iPhysicalAddress);
+
+    /*!
+     * @return The physical address of the device that the given address is connected to. The root is its own parent.
+     */
+    static uint16_t GetParent(uint16_t iPhysicalAddress);
+
+    /*!
+     * @return The port of the parent that the given address is connected to, or 0 for the root.
+     */
+    static uint8_t GetPort(uint16_t iPhysicalAddress);
+
+    /*!
+     * @return The physical address of the given port of a device, or CEC_INVALID_PHYSICAL_ADDRESS when the tree is not that deep.
+     */
+    static uint16_t GetChild(uint16_t iPhysicalAddress, uint8_t iPort);
+
+    /*!
+     * @return True when the stream from iPhysicalAddress to the root passes iAncestor, or when they are equal.
+     */
+    static bool IsBelow(uint16_t iAncestor, uint16_t iPhysicalAddress);
+
+  private:
+    int  FindNode(uint16_t iPhysicalAddress) const;
+    int  CreateNode(uint16_t iPhysicalAddress);
+    void RemoveNode(int iNode);
+
+    cec_topology_node m_nodes[CEC_TOPOLOGY_MAX_NODES];
+    uint16_t          m_addresses[16];
+    mutable CMutex    m_mutex;
+  };
+};
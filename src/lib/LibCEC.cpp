@@ -36,16 +36,20 @@
 #include "AdapterDetection.h"
 #include "CECProcessor.h"
 #include "devices/CECBusDevice.h"
+#include "implementations/CECCommandHandler.h"
 #include "util/StdString.h"
 #include "platform/timeutils.h"
+#include "util/log.h"
 
 using namespace std;
 using namespace CEC;
 
 CLibCEC::CLibCEC(const char *strDeviceName, cec_device_type_list types) :
     m_iStartTime(GetTimeMs()),
+    m_iLogLevel(CEC_LOG_ALL),
     m_iCurrentButton(CEC_USER_CONTROL_CODE_UNKNOWN),
-    m_buttontime(0)
+    m_buttontime(0),
+    m_callbacks(&m_logBuffer)
 {
   m_comm = new CAdapterCommunication(this);
   m_cec = new CCECProcessor(this, m_comm, strDeviceName, types);
@@ -53,8 +57,10 @@ CLibCEC::CLibCEC(const char *strDeviceName, cec_device_type_list types) :
 
 CLibCEC::CLibCEC(const char *strDeviceName, cec_logical_address iLogicalAddress /* = CECDEVICE_PLAYBACKDEVICE1 */, uint16_t iPhysicalAddress /* = CEC_DEFAULT_PHYSICAL_ADDRESS */) :
     m_iStartTime(GetTimeMs()),
+    m_iLogLevel(CEC_LOG_ALL),
     m_iCurrentButton(CEC_USER_CONTROL_CODE_UNKNOWN),
-    m_buttontime(0)
+    m_buttontime(0),
+    m_callbacks(&m_logBuffer)
 {
   m_comm = new CAdapterCommunication(this);
   m_cec = new CCECProcessor(this, m_comm, strDeviceName, iLogicalAddress, iPhysicalAddress);
@@ -63,6 +69,8 @@ CLibCEC::CLibCEC(const char *strDeviceName, cec_logical_address iLogicalAddress
 CLibCEC::~CLibCEC(void)
 {
   Close();
+  /* the callbacks may still call into this instance */
+  m_callbacks.StopThread();
   delete m_cec;
   delete m_comm;
 }
@@ -97,6 +105,9 @@ bool CLibCEC::Open(const char *strPort, uint32_t iTimeoutMs /* = 10000 */)
     return false;
   }
 
+  if (m_cec->LoadDeviceCache(strPort))
+    AddLog(CEC_LOG_NOTICE, "using the cached bus configuration");
+
   if (!m_cec->Start())
   {
     AddLog(CEC_LOG_ERROR, "could not start CEC communications");
@@ -109,19 +120,24 @@ bool CLibCEC::Open(const char *strPort, uint32_t iTimeoutMs /* = 10000 */)
 void CLibCEC::Close(void)
 {
   if (m_cec)
+  {
     m_cec->StopThread();
+    m_cec->SaveDeviceCache();
+  }
   if (m_comm)
     m_comm->Close();
+
+  /* report the transmissions that were aborted by closing the connection */
+  if (m_cec)
+    m_cec->HandleTransmitCallbacks();
 }
 
 int8_t CLibCEC::FindAdapters(cec_adapter *deviceList, uint8_t iBufSize, const char *strDevicePath /* = NULL */)
 {
-  CStdString strDebug;
   if (strDevicePath)
-    strDebug.Format("trying to autodetect the com port for device path '%s'", strDevicePath);
+    LIB_CEC_LOG(this, CEC_LOG_DEBUG, "trying to autodetect the com port for device path '%s'", strDevicePath);
   else
-    strDebug.Format("trying to autodetect all CEC adapters");
-  AddLog(CEC_LOG_DEBUG, strDebug);
+    AddLog(CEC_LOG_DEBUG, "trying to autodetect all CEC adapters");
 
   return CAdapterDetection::FindAdapters(deviceList, iBufSize, strDevicePath);
 }
@@ -138,17 +154,82 @@ bool CLibCEC::StartBootloader(void)
 
 bool CLibCEC::GetNextLogMessage(cec_log_message *message)
 {
-  return (m_logBuffer.Pop(*message));
+  bool bReturn = m_logBuffer.Pop(*message);
+  ResetEvent();
+  return bReturn;
 }
 
 bool CLibCEC::GetNextKeypress(cec_keypress *key)
 {
-  return m_keyBuffer.Pop(*key);
+  bool bReturn = m_keyBuffer.Pop(*key);
+  ResetEvent();
+  return bReturn;
 }
 
 bool CLibCEC::GetNextCommand(cec_command *command)
 {
-  return m_commandBuffer.Pop(*command);
+  bool bReturn = m_commandBuffer.Pop(*command);
+  ResetEvent();
+  return bReturn;
+}
+
+uint32_t CLibCEC::GetNextLogMessages(cec_log_message *messages, uint32_t iMax)
+{
+  uint32_t iReturn = messages ? m_logBuffer.Pop(messages, iMax) : 0;
+  ResetEvent();
+  return iReturn;
+}
+
+uint32_t CLibCEC::GetNextKeypresses(cec_keypress *keys, uint32_t iMax)
+{
+  uint32_t iReturn = keys ? m_keyBuffer.Pop(keys, iMax) : 0;
+  ResetEvent();
+  return iReturn;
+}
+
+uint32_t CLibCEC::GetNextCommands(cec_command *commands, uint32_t iMax)
+{
+  uint32_t iReturn = commands ? m_commandBuffer.Pop(commands, iMax) : 0;
+  ResetEvent();
+  return iReturn;
+}
+
+int CLibCEC::GetEventFd(void)
+{
+  CLockObject lock(&m_eventMutex);
+  if (!m_event.IsOpen())
+  {
+    if (!m_event.Open())
+      return -1;
+
+    /* entries may have been added before the descriptor was opened */
+    if (!m_logBuffer.IsEmpty() || !m_keyBuffer.IsEmpty() || !m_commandBuffer.IsEmpty())
+      m_event.Signal();
+  }
+
+  return m_event.GetFd();
+}
+
+void CLibCEC::SignalEvent(void)
+{
+  /* the descriptor is only opened by GetEventFd() */
+  if (!m_event.IsOpen())
+    return;
+
+  CLockObject lock(&m_eventMutex);
+  m_event.Signal();
+}
+
+void CLibCEC::ResetEvent(void)
+{
+  if (!m_event.IsOpen())
+    return;
+
+  /* an entry that is added after a buffer was checked signals the descriptor again after this,
+     because it's pushed before SignalEvent() takes the lock */
+  CLockObject lock(&m_eventMutex);
+  if (m_logBuffer.IsEmpty() && m_keyBuffer.IsEmpty() && m_commandBuffer.IsEmpty())
+    m_event.Reset();
 }
 
 bool CLibCEC::Transmit(const cec_command &data)
@@ -251,6 +332,34 @@ cec_power_status CLibCEC::GetDevicePowerStatus(cec_logical_address iAddress)
   return CEC_POWER_STATUS_UNKNOWN;
 }
 
+cec_version CLibCEC::GetCachedDeviceCecVersion(cec_logical_address iAddress, int64_t *iAgeMs /* = NULL */)
+{
+  if (m_cec && iAddress >= CECDEVICE_TV && iAddress < CECDEVICE_BROADCAST)
+    return m_cec->GetCachedDeviceCecVersion(iAddress, iAgeMs);
+  return CEC_VERSION_UNKNOWN;
+}
+
+bool CLibCEC::GetCachedDeviceMenuLanguage(cec_logical_address iAddress, cec_menu_language *language, int64_t *iAgeMs /* = NULL */)
+{
+  if (m_cec && iAddress >= CECDEVICE_TV && iAddress < CECDEVICE_BROADCAST)
+    return m_cec->GetCachedDeviceMenuLanguage(iAddress, language, iAgeMs);
+  return false;
+}
+
+uint64_t CLibCEC::GetCachedDeviceVendorId(cec_logical_address iAddress, int64_t *iAgeMs /* = NULL */)
+{
+  if (m_cec && iAddress >= CECDEVICE_TV && iAddress < CECDEVICE_BROADCAST)
+    return m_cec->GetCachedDeviceVendorId(iAddress, iAgeMs);
+  return 0;
+}
+
+cec_power_status CLibCEC::GetCachedDevicePowerStatus(cec_logical_address iAddress, int64_t *iAgeMs /* = NULL */)
+{
+  if (m_cec && iAddress >= CECDEVICE_TV && iAddress < CECDEVICE_BROADCAST)
+    return m_cec->GetCachedDevicePowerStatus(iAddress, iAgeMs);
+  return CEC_POWER_STATUS_UNKNOWN;
+}
+
 bool CLibCEC::PollDevice(cec_logical_address iAddress)
 {
   if (m_cec && iAddress >= CECDEVICE_TV && iAddress < CECDEVICE_BROADCAST)
@@ -302,21 +411,75 @@ uint8_t CLibCEC::MuteAudio(void)
   return 0;
 }
 
+uint32_t CLibCEC::TransmitAsync(const cec_command &data, CBCecTransmitDone callback, void *param /* = NULL */)
+{
+  return m_cec ? m_cec->TransmitAsync(data, callback, param) : 0;
+}
+
+bool CLibCEC::GetTransmitStats(cec_transmit_class transmitClass, cec_transmit_class_stats *stats)
+{
+  return m_cec ? m_cec->GetTransmitStats(transmitClass, stats) : false;
+}
+
+bool CLibCEC::ScanBus(cec_bus_scan_result *result, bool bPrefetch /* = true */)
+{
+  return m_cec ? m_cec->ScanBus(result, bPrefetch) : false;
+}
+
+bool CLibCEC::EnableDeviceCache(const char *strDirectory)
+{
+  if (m_comm && m_comm->IsOpen())
+  {
+    AddLog(CEC_LOG_ERROR, "the device cache can't be changed while the connection is open");
+    return false;
+  }
+
+  return m_cec ? m_cec->EnableDeviceCache(strDirectory) : false;
+}
+
+bool CLibCEC::EnableCallbacks(const cec_callbacks *callbacks, void *param /* = NULL */)
+{
+  if (!m_callbacks.SetCallbacks(callbacks, param))
+  {
+    AddLog(CEC_LOG_ERROR, "could not create a callback thread");
+    return false;
+  }
+  return true;
+}
+
+void CLibCEC::SetLogLevel(int iLogLevel)
+{
+  m_iLogLevel = iLogLevel & CEC_LOG_ALL;
+}
+
+void CLibCEC::EnableOpcodeNames(bool bEnable)
+{
+  cec_log_opcode_name opcodeName = &CCECCommandHandler::ToString;
+  m_logBuffer.SetOpcodeNames(bEnable ? opcodeName : NULL);
+}
+
 void CLibCEC::AddLog(cec_log_level level, const string &strMessage)
 {
-  if (m_cec)
+  if (m_cec && IsLogLevelEnabled(level))
   {
-    cec_log_message message;
-    message.level = level;
-    message.time = GetTimeMs() - m_iStartTime;
-    snprintf(message.message, sizeof(message.message), "%s", strMessage.c_str());
-    m_logBuffer.Push(message);
+    if (m_logBuffer.Push(level, GetTimeMs() - m_iStartTime, strMessage.c_str(), strMessage.length()) && !m_callbacks.AddLog())
+      SignalEvent();
+  }
+}
+
+void CLibCEC::AddTraffic(const cec_command &command, bool bOutgoing)
+{
+  if (m_cec && IsLogLevelEnabled(CEC_LOG_TRAFFIC))
+  {
+    if (m_logBuffer.Push(GetTimeMs() - m_iStartTime, command, bOutgoing) && !m_callbacks.AddLog())
+      SignalEvent();
   }
 }
 
 void CLibCEC::AddKey(cec_keypress &key)
 {
-  m_keyBuffer.Push(key);
+  if (!m_callbacks.AddKey(key) && m_keyBuffer.Push(key))
+    SignalEvent();
   m_iCurrentButton = CEC_USER_CONTROL_CODE_UNKNOWN;
   m_buttontime = 0;
 }
@@ -329,7 +492,8 @@ void CLibCEC::AddKey(void)
 
     key.duration = (unsigned int) (GetTimeMs() - m_buttontime);
     key.keycode = m_iCurrentButton;
-    m_keyBuffer.Push(key);
+    if (!m_callbacks.AddKey(key) && m_keyBuffer.Push(key))
+      SignalEvent();
     m_iCurrentButton = CEC_USER_CONTROL_CODE_UNKNOWN;
   }
   m_buttontime = 0;
@@ -337,11 +501,14 @@ void CLibCEC::AddKey(void)
 
 void CLibCEC::AddCommand(const cec_command &command)
 {
-  if (m_commandBuffer.Push(command))
+  if (m_callbacks.AddCommand(command))
   {
-    CStdString strDebug;
-    strDebug.Format("stored command '%2x' in the command buffer. buffer size = %d", command.opcode, m_commandBuffer.Size());
-    AddLog(CEC_LOG_DEBUG, strDebug);
+    LIB_CEC_LOG(this, CEC_LOG_DEBUG, "passed command '%2x' to the command callback", command.opcode);
+  }
+  else if (m_commandBuffer.Push(command))
+  {
+    SignalEvent();
+    LIB_CEC_LOG(this, CEC_LOG_DEBUG, "stored command '%2x' in the command buffer. buffer size = %d", command.opcode, m_commandBuffer.Size());
   }
   else
   {
@@ -349,6 +516,16 @@ void CLibCEC::AddCommand(const cec_command &command)
   }
 }
 
+void CLibCEC::AddStateChange(const cec_state_change &change)
+{
+  m_callbacks.AddStateChange(change);
+}
+
+void CLibCEC::AddTransmitDone(CBCecTransmitDone callback, void *param, uint32_t iTicket, cec_transmit_status status)
+{
+  m_callbacks.AddTransmitDone(callback, param, iTicket, status);
+}
+
 void CLibCEC::CheckKeypressTimeout(void)
 {
   if (m_iCurrentButton != CEC_USER_CONTROL_CODE_UNKNOWN && GetTimeMs() - m_buttontime > CEC_BUTTON_TIMEOUT)
@@ -368,7 +545,8 @@ void CLibCEC::SetCurrentButton(cec_user_control_code iButtonCode)
   cec_keypress key;
   key.duration = 0;
   key.keycode = m_iCurrentButton;
-  m_keyBuffer.Push(key);
+  if (!m_callbacks.AddKey(key) && m_keyBuffer.Push(key))
+    SignalEvent();
 }
 
 void * CECCreate(const char *strDeviceName, CEC::cec_logical_address iLogicalAddress /*= CEC::CECDEVICE_PLAYBACKDEVICE1 */, uint16_t iPhysicalAddress /* = CEC_DEFAULT_PHYSICAL_ADDRESS */)
@@ -34,6 +34,9 @@
 #include <string>
 #include <cec.h>
 #include "util/buffer.h"
+#include "util/logbuffer.h"
+#include "CallbackDispatcher.h"
+#include "platform/eventfd.h"
 
 namespace CEC
 {
@@ -91,23 +94,49 @@ namespace CEC
       virtual uint8_t VolumeUp(void);
       virtual uint8_t VolumeDown(void);
       virtual uint8_t MuteAudio(void);
+      virtual uint32_t TransmitAsync(const cec_command &data, CBCecTransmitDone callback, void *param = NULL);
+      virtual bool GetTransmitStats(cec_transmit_class transmitClass, cec_transmit_class_stats *stats);
+      virtual bool ScanBus(cec_bus_scan_result *result, bool bPrefetch = true);
+      virtual cec_version GetCachedDeviceCecVersion(cec_logical_address iAddress, int64_t *iAgeMs = NULL);
+      virtual bool GetCachedDeviceMenuLanguage(cec_logical_address iAddress, cec_menu_language *language, int64_t *iAgeMs = NULL);
+      virtual uint64_t GetCachedDeviceVendorId(cec_logical_address iAddress, int64_t *iAgeMs = NULL);
+      virtual cec_power_status GetCachedDevicePowerStatus(cec_logical_address iAddress, int64_t *iAgeMs = NULL);
+      virtual bool EnableDeviceCache(const char *strDirectory);
+      virtual bool EnableCallbacks(const cec_callbacks *callbacks, void *param = NULL);
+      virtual int GetEventFd(void);
+      virtual uint32_t GetNextLogMessages(cec_log_message *messages, uint32_t iMax);
+      virtual uint32_t GetNextKeypresses(cec_keypress *keys, uint32_t iMax);
+      virtual uint32_t GetNextCommands(cec_command *commands, uint32_t iMax);
+      virtual void SetLogLevel(int iLogLevel);
+      virtual void EnableOpcodeNames(bool bEnable);
     //@}
 
       virtual void AddLog(cec_log_level level, const std::string &strMessage);
+      virtual void AddTraffic(const cec_command &command, bool bOutgoing);
+      bool IsLogLevelEnabled(cec_log_level level) const { return (m_iLogLevel & level) == level; }
       virtual void AddKey(void);
       virtual void AddKey(cec_keypress &key);
       virtual void AddCommand(const cec_command &command);
+      virtual void AddStateChange(const cec_state_change &change);
+      virtual void AddTransmitDone(CBCecTransmitDone callback, void *param, uint32_t iTicket, cec_transmit_status status);
       virtual void CheckKeypressTimeout(void);
       virtual void SetCurrentButton(cec_user_control_code iButtonCode);
 
     protected:
+      void SignalEvent(void);
+      void ResetEvent(void);
+
       int64_t                    m_iStartTime;
+      volatile int               m_iLogLevel;
       cec_user_control_code      m_iCurrentButton;
       int64_t                    m_buttontime;
       CCECProcessor             *m_cec;
       CAdapterCommunication     *m_comm;
-      CecBuffer<cec_log_message> m_logBuffer;
+      CecLogBuffer               m_logBuffer;
       CecBuffer<cec_keypress>    m_keyBuffer;
       CecBuffer<cec_command>     m_commandBuffer;
+      CCallbackDispatcher        m_callbacks;
+      CEventFd                   m_event;
+      CMutex                     m_eventMutex;
   };
 };
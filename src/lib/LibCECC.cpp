@@ -144,6 +144,20 @@ int cec_transmit(const CEC::cec_command *data)
   return -1;
 }
 
+uint32_t cec_transmit_async(const CEC::cec_command *data, CBCecTransmitDone callback, void *param)
+{
+  if (cec_parser)
+    return cec_parser->TransmitAsync(*data, callback, param);
+  return 0;
+}
+
+int cec_get_transmit_stats(cec_transmit_class transmitClass, cec_transmit_class_stats *stats)
+{
+  if (cec_parser)
+    return cec_parser->GetTransmitStats(transmitClass, stats) ? 1 : 0;
+  return -1;
+}
+
 int cec_set_logical_address(cec_logical_address iLogicalAddress /* = CECDEVICE_PLAYBACKDEVICE1 */)
 {
   if (cec_parser)
@@ -254,6 +268,34 @@ cec_power_status cec_get_device_power_status(cec_logical_address iLogicalAddress
   return CEC_POWER_STATUS_UNKNOWN;
 }
 
+cec_version cec_get_cached_device_cec_version(cec_logical_address iLogicalAddress, int64_t *iAgeMs)
+{
+  if (cec_parser)
+    return cec_parser->GetCachedDeviceCecVersion(iLogicalAddress, iAgeMs);
+  return CEC_VERSION_UNKNOWN;
+}
+
+int cec_get_cached_device_menu_language(cec_logical_address iLogicalAddress, cec_menu_language *language, int64_t *iAgeMs)
+{
+  if (cec_parser)
+    return cec_parser->GetCachedDeviceMenuLanguage(iLogicalAddress, language, iAgeMs) ? 1 : 0;
+  return -1;
+}
+
+uint64_t cec_get_cached_device_vendor_id(cec_logical_address iLogicalAddress, int64_t *iAgeMs)
+{
+  if (cec_parser)
+    return cec_parser->GetCachedDeviceVendorId(iLogicalAddress, iAgeMs);
+  return 0;
+}
+
+cec_power_status cec_get_cached_device_power_status(cec_logical_address iLogicalAddress, int64_t *iAgeMs)
+{
+  if (cec_parser)
+    return cec_parser->GetCachedDevicePowerStatus(iLogicalAddress, iAgeMs);
+  return CEC_POWER_STATUS_UNKNOWN;
+}
+
 int cec_poll_device(cec_logical_address iLogicalAddress)
 {
   if (cec_parser)
@@ -269,6 +311,13 @@ cec_logical_addresses cec_get_active_devices(void)
   return addresses;
 }
 
+int cec_scan_bus(cec_bus_scan_result *result, int bPrefetch)
+{
+  if (cec_parser)
+    return cec_parser->ScanBus(result, bPrefetch == 1) ? 1 : 0;
+  return -1;
+}
+
 int cec_is_active_device(cec_logical_address iAddress)
 {
   if (cec_parser)
@@ -311,4 +360,66 @@ int cec_mute_audio(void)
   return -1;
 }
 
+int cec_enable_device_cache(const char *strDirectory)
+{
+  if (cec_parser)
+    return cec_parser->EnableDeviceCache(strDirectory) ? 1 : 0;
+  return -1;
+}
+
+int cec_enable_callbacks(const cec_callbacks *callbacks, void *param)
+{
+  if (cec_parser)
+    return cec_parser->EnableCallbacks(callbacks, param) ? 1 : 0;
+  return -1;
+}
+
+int cec_get_event_fd(void)
+{
+  if (cec_parser)
+    return cec_parser->GetEventFd();
+  return -1;
+}
+
+int cec_get_next_log_messages(cec_log_message *messages, uint32_t iMax)
+{
+  if (cec_parser)
+    return (int) cec_parser->GetNextLogMessages(messages, iMax);
+  return -1;
+}
+
+int cec_get_next_keypresses(cec_keypress *keys, uint32_t iMax)
+{
+  if (cec_parser)
+    return (int) cec_parser->GetNextKeypresses(keys, iMax);
+  return -1;
+}
+
+int cec_get_next_commands(cec_command *commands, uint32_t iMax)
+{
+  if (cec_parser)
+    return (int) cec_parser->GetNextCommands(commands, iMax);
+  return -1;
+}
+
+int cec_set_log_level(int iLogLevel)
+{
+  if (cec_parser)
+  {
+    cec_parser->SetLogLevel(iLogLevel);
+    return 1;
+  }
+  return -1;
+}
+
+int cec_enable_opcode_names(int bEnable)
+{
+  if (cec_parser)
+  {
+    cec_parser->EnableOpcodeNames(bEnable == 1);
+    return 1;
+  }
+  return -1;
+}
+
 //@}
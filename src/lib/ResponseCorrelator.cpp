@@ -0,0 +1,138 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "ResponseCorrelator.h"
+#include "platform/timeutils.h"
+
+using namespace CEC;
+using namespace std;
+
+CResponseCorrelator::CResponseCorrelator(void) :
+    m_iLastHandle(0)
+{
+}
+
+CResponseCorrelator::~CResponseCorrelator(void)
+{
+  AbortAll();
+
+  CLockObject lock(&m_mutex);
+  for (map<uint32_t, cec_pending_request *>::iterator it = m_requests.begin(); it != m_requests.end(); it++)
+    delete it->second;
+  m_requests.clear();
+}
+
+uint32_t CResponseCorrelator::Register(cec_opcode request, cec_opcode reply)
+{
+  cec_pending_request *pending = new cec_pending_request;
+  pending->request  = request;
+  pending->reply    = reply;
+  pending->bReplied = false;
+  pending->bAborted = false;
+
+  CLockObject lock(&m_mutex);
+  if (++m_iLastHandle == 0)
+    ++m_iLastHandle;
+  m_requests.insert(make_pair(m_iLastHandle, pending));
+  return m_iLastHandle;
+}
+
+bool CResponseCorrelator::Wait(uint32_t iHandle, uint32_t iTimeoutMs /* = 1000 */)
+{
+  CLockObject lock(&m_mutex);
+  map<uint32_t, cec_pending_request *>::iterator it = m_requests.find(iHandle);
+  if (it == m_requests.end())
+    return false;
+
+  cec_pending_request *pending = it->second;
+  int64_t iNow = GetTimeMs();
+  int64_t iTarget = iNow + iTimeoutMs;
+  while (!pending->bReplied && !pending->bAborted && iNow < iTarget)
+  {
+    pending->condition.Wait(&m_mutex, (uint32_t) (iTarget - iNow));
+    iNow = GetTimeMs();
+  }
+
+  bool bReturn(pending->bReplied);
+  m_requests.erase(iHandle);
+  delete pending;
+  return bReturn;
+}
+
+void CResponseCorrelator::Cancel(uint32_t iHandle)
+{
+  CLockObject lock(&m_mutex);
+  map<uint32_t, cec_pending_request *>::iterator it = m_requests.find(iHandle);
+  if (it != m_requests.end())
+  {
+    delete it->second;
+    m_requests.erase(it);
+  }
+}
+
+bool CResponseCorrelator::HandleCommand(const cec_command &command)
+{
+  bool bReturn(false);
+  if (command.opcode != CEC_OPCODE_FEATURE_ABORT && !CCECOpcodeInfo::IsReply(command.opcode))
+    return bReturn;
+
+  CLockObject lock(&m_mutex);
+  for (map<uint32_t, cec_pending_request *>::iterator it = m_requests.begin(); it != m_requests.end(); it++)
+  {
+    cec_pending_request *pending = it->second;
+    if (pending->bReplied || pending->bAborted)
+      continue;
+
+    if (command.opcode == pending->reply)
+      pending->bReplied = true;
+    else if (command.opcode == CEC_OPCODE_FEATURE_ABORT && command.parameters.size > 0 &&
+        command.parameters[0] == (uint8_t) pending->request)
+      pending->bAborted = true;
+    else
+      continue;
+
+    pending->condition.Signal();
+    bReturn = true;
+  }
+
+  return bReturn;
+}
+
+void CResponseCorrelator::AbortAll(void)
+{
+  CLockObject lock(&m_mutex);
+  for (map<uint32_t, cec_pending_request *>::iterator it = m_requests.begin(); it != m_requests.end(); it++)
+  {
+    it->second->bAborted = true;
+    it->second->condition.Signal();
+  }
+}
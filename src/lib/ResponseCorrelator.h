@@ -0,0 +1,106 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include <cectypes.h>
+#include "CECOpcodeInfo.h"
+#include "platform/threads.h"
+#include <map>
+
+namespace CEC
+{
+  typedef struct cec_pending_request
+  {
+    cec_opcode request;
+    cec_opcode reply;
+    bool       bReplied;
+    bool       bAborted;
+    CCondition condition;
+  } cec_pending_request;
+
+  /*!
+   * @brief Matches incoming frames to the requests that were sent to a device, so a waiter only wakes up
+   *        when the reply to its own request arrived.
+   */
+  class CResponseCorrelator
+  {
+  public:
+    CResponseCorrelator(void);
+    virtual ~CResponseCorrelator(void);
+
+    /*!
+     * @brief Register a request. Call this before the request is transmitted, so a reply that arrives
+     *        before the caller starts waiting isn't missed.
+     * @param request The opcode of the request. A feature abort for this opcode ends the request.
+     * @param reply The opcode of the expected reply.
+     * @return The handle to pass to Wait() or Cancel().
+     */
+    uint32_t Register(cec_opcode request, cec_opcode reply);
+
+    /*!
+     * @brief Register a request that expects the reply from the opcode table.
+     */
+    uint32_t Register(cec_opcode request) { return Register(request, CCECOpcodeInfo::GetReply(request)); }
+
+    /*!
+     * @brief Wait for the reply to a request and unregister it.
+     * @param iHandle The handle that was returned by Register().
+     * @param iTimeoutMs The maximum time in ms to wait for the reply.
+     * @return True when the expected reply was received, false when the request was aborted or timed out.
+     */
+    bool Wait(uint32_t iHandle, uint32_t iTimeoutMs = 1000);
+
+    /*!
+     * @brief Unregister a request without waiting for it, e.g. because it could not be transmitted.
+     * @param iHandle The handle that was returned by Register().
+     */
+    void Cancel(uint32_t iHandle);
+
+    /*!
+     * @brief Wake up the waiters of the requests that are answered or aborted by a frame. Frames that aren't a
+     *        reply according to the opcode table or a feature abort are skipped without taking the lock.
+     * @param command The frame that was received from the device.
+     * @return True when the frame matched at least one request, false otherwise.
+     */
+    bool HandleCommand(const cec_command &command);
+
+    /*!
+     * @brief Abort all outstanding requests.
+     */
+    void AbortAll(void);
+
+  private:
+    std::map<uint32_t, cec_pending_request *> m_requests;
+    uint32_t                                  m_iLastHandle;
+    CMutex                                    m_mutex;
+  };
+};
@@ -33,6 +33,7 @@
 #include "CECAudioSystem.h"
 #include "../CECProcessor.h"
 #include "../implementations/CECCommandHandler.h"
+#include "../util/log.h"
 
 using namespace CEC;
 
@@ -48,9 +49,7 @@ bool CCECAudioSystem::SetAudioStatus(uint8_t status)
 {
   if (m_audioStatus != status)
   {
-    CStdString strLog;
-    strLog.Format(">> %s (%X): audio status changed from %2x to %2x", GetLogicalAddressName(), m_iLogicalAddress, m_audioStatus, status);
-    AddLog(CEC_LOG_DEBUG, strLog.c_str());
+    LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, ">> %s (%X): audio status changed from %2x to %2x", GetLogicalAddressName(), m_iLogicalAddress, m_audioStatus, status);
 
     m_audioStatus = status;
     return true;
@@ -63,9 +62,7 @@ bool CCECAudioSystem::SetSystemAudioMode(const cec_system_audio_status mode)
 {
   if (m_systemAudioStatus != mode)
   {
-    CStdString strLog;
-    strLog.Format(">> %s (%X): system audio mode changed from %s to %s", GetLogicalAddressName(), m_iLogicalAddress, CCECCommandHandler::ToString(m_systemAudioStatus), CCECCommandHandler::ToString(mode));
-    AddLog(CEC_LOG_DEBUG, strLog.c_str());
+    LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, ">> %s (%X): system audio mode changed from %s to %s", GetLogicalAddressName(), m_iLogicalAddress, CCECCommandHandler::ToString(m_systemAudioStatus), CCECCommandHandler::ToString(mode));
 
     m_systemAudioStatus = mode;
     return true;
@@ -85,9 +82,7 @@ bool CCECAudioSystem::SetSystemAudioMode(const cec_command &command)
 
 bool CCECAudioSystem::TransmitAudioStatus(cec_logical_address dest)
 {
-  CStdString strLog;
-  strLog.Format("<< %x -> %x: audio status '%2x'", m_iLogicalAddress, dest, m_audioStatus);
-  AddLog(CEC_LOG_NOTICE, strLog);
+  LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< %x -> %x: audio status '%2x'", m_iLogicalAddress, dest, m_audioStatus);
 
   cec_command command;
   cec_command::Format(command, m_iLogicalAddress, dest, CEC_OPCODE_REPORT_AUDIO_STATUS);
@@ -98,9 +93,7 @@ bool CCECAudioSystem::TransmitAudioStatus(cec_logical_address dest)
 
 bool CCECAudioSystem::TransmitSystemAudioModeStatus(cec_logical_address dest)
 {
-  CStdString strLog;
-  strLog.Format("<< %x -> %x: system audio mode '%s'", m_iLogicalAddress, dest, CCECCommandHandler::ToString(m_systemAudioStatus));
-  AddLog(CEC_LOG_NOTICE, strLog);
+  LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< %x -> %x: system audio mode '%s'", m_iLogicalAddress, dest, CCECCommandHandler::ToString(m_systemAudioStatus));
 
   cec_command command;
   cec_command::Format(command, m_iLogicalAddress, dest, CEC_OPCODE_SYSTEM_AUDIO_MODE_STATUS);
@@ -127,6 +120,9 @@ uint8_t CCECAudioSystem::MuteAudio(void)
 uint8_t CCECAudioSystem::SendKey(cec_user_control_code key)
 {
   {
+    /* the audio system reports the new status after the key was released */
+    uint32_t iHandle = m_responses.Register(CEC_OPCODE_USER_CONTROL_PRESSED, CEC_OPCODE_REPORT_AUDIO_STATUS);
+
     CLockObject lock(&m_transmitMutex);
     cec_command command;
     cec_command::Format(command, m_processor->GetLogicalAddress(), m_iLogicalAddress, CEC_OPCODE_USER_CONTROL_PRESSED);
@@ -134,8 +130,13 @@ uint8_t CCECAudioSystem::SendKey(cec_user_control_code key)
     m_processor->Transmit(command);
 
     cec_command::Format(command, m_processor->GetLogicalAddress(), m_iLogicalAddress, CEC_OPCODE_USER_CONTROL_RELEASE);
-    if (m_processor->Transmit(command))
-      m_condition.Wait(&m_transmitMutex, 1000);
+    bool bSent = m_processor->Transmit(command);
+    lock.Leave();
+
+    if (bSent)
+      m_responses.Wait(iHandle);
+    else
+      m_responses.Cancel(iHandle);
   }
 
   CLockObject lock(&m_mutex);
@@ -32,16 +32,34 @@
 
 #include "CECBusDevice.h"
 #include "../CECProcessor.h"
-#include "../implementations/ANCommandHandler.h"
 #include "../implementations/CECCommandHandler.h"
-#include "../implementations/SLCommandHandler.h"
-#include "../implementations/VLCommandHandler.h"
+#include "../platform/atomics.h"
 #include "../platform/timeutils.h"
+#include "../util/log.h"
 
 using namespace CEC;
 
 #define ToString(p) CCECCommandHandler::ToString(p)
 
+/* the time in ms after which a cached value expires */
+static const int64_t g_iCacheTTL[CEC_CACHED_MAX + 1] = {
+  10000,  /* power status */
+  300000, /* vendor id */
+  300000, /* cec version */
+  60000   /* menu language */
+};
+
+/* the requests that refresh a cached value */
+static const cec_opcode g_cacheRequest[CEC_CACHED_MAX + 1] = {
+  CEC_OPCODE_GIVE_DEVICE_POWER_STATUS,
+  CEC_OPCODE_GIVE_DEVICE_VENDOR_ID,
+  CEC_OPCODE_GET_CEC_VERSION,
+  CEC_OPCODE_GET_MENU_LANGUAGE
+};
+
+/* the time in ms between two requests for the vendor id of an active device that didn't report it */
+#define CEC_VENDOR_POLL_INTERVAL 5000
+
 CCECBusDevice::CCECBusDevice(CCECProcessor *processor, cec_logical_address iLogicalAddress, uint16_t iPhysicalAddress) :
   m_type(CEC_DEVICE_TYPE_RESERVED),
   m_iPhysicalAddress(iPhysicalAddress),
@@ -57,20 +75,25 @@ CCECBusDevice::CCECBusDevice(CCECProcessor *processor, cec_logical_address iLogi
   m_cecVersion(CEC_VERSION_UNKNOWN),
   m_deviceStatus(CEC_DEVICE_STATUS_UNKNOWN)
 {
-  m_handler = new CCECCommandHandler(this);
+  m_handler = m_processor->GetHandler(CEC_VENDOR_UNKNOWN);
 
   for (unsigned int iPtr = 0; iPtr < 4; iPtr++)
     m_menuLanguage.language[iPtr] = '?';
   m_menuLanguage.language[3] = 0;
   m_menuLanguage.device = iLogicalAddress;
 
+  for (unsigned int iPtr = 0; iPtr <= CEC_CACHED_MAX; iPtr++)
+  {
+    m_iUpdated[iPtr]          = 0;
+    m_iRefreshRequested[iPtr] = 0;
+  }
+
   m_strDeviceName = ToString(m_iLogicalAddress);
 }
 
 CCECBusDevice::~CCECBusDevice(void)
 {
-  m_condition.Broadcast();
-  delete m_handler;
+  m_responses.AbortAll();
 }
 
 void CCECBusDevice::AddLog(cec_log_level level, const CStdString &strMessage)
@@ -82,38 +105,171 @@ bool CCECBusDevice::HandleCommand(const cec_command &command)
 {
   CLockObject lock(&m_transmitMutex);
   m_iLastActive = GetTimeMs();
-  m_handler->HandleCommand(command);
+  GetHandler()->HandleCommand(command);
   if (m_deviceStatus != CEC_DEVICE_STATUS_HANDLED_BY_LIBCEC)
     m_deviceStatus = CEC_DEVICE_STATUS_PRESENT;
-  m_condition.Signal();
+
+  /* only wake up the callers that are waiting for this frame, after the handler updated our state */
+  m_responses.HandleCommand(command);
   return true;
 }
 
-void CCECBusDevice::PollVendorId(void)
+void CCECBusDevice::LearnFromCommand(const cec_command &command)
+{
+  if (MyLogicalAddressContains(m_iLogicalAddress))
+    return;
+
+  {
+    CLockObject lock(&m_mutex);
+    m_iLastActive = GetTimeMs();
+    m_deviceStatus = CEC_DEVICE_STATUS_PRESENT;
+  }
+
+  switch (command.opcode)
+  {
+  case CEC_OPCODE_REPORT_PHYSICAL_ADDRESS:
+    if (command.parameters.size == 3)
+      SetPhysicalAddress(((uint16_t)command.parameters[0] << 8) | ((uint16_t)command.parameters[1]));
+    break;
+  case CEC_OPCODE_ACTIVE_SOURCE:
+    /* the active source reports its own physical address, and is powered on */
+    if (command.parameters.size == 2)
+    {
+      SetPhysicalAddress(((uint16_t)command.parameters[0] << 8) | ((uint16_t)command.parameters[1]));
+      SetActiveDevice();
+    }
+    break;
+  case CEC_OPCODE_INACTIVE_SOURCE:
+    SetInactiveDevice();
+    break;
+  case CEC_OPCODE_ROUTING_CHANGE:
+    if (command.parameters.size == 4)
+      SetStreamPath(((uint16_t)command.parameters[2] << 8) | ((uint16_t)command.parameters[3]),
+                    ((uint16_t)command.parameters[0] << 8) | ((uint16_t)command.parameters[1]));
+    break;
+  case CEC_OPCODE_ROUTING_INFORMATION:
+  case CEC_OPCODE_SET_STREAM_PATH:
+    if (command.parameters.size == 2)
+      SetStreamPath(((uint16_t)command.parameters[0] << 8) | ((uint16_t)command.parameters[1]));
+    break;
+  case CEC_OPCODE_DEVICE_VENDOR_ID:
+    if (command.parameters.size == 3)
+      SetVendorId(((uint64_t)command.parameters[0] << 16) + ((uint64_t)command.parameters[1] << 8) + (uint64_t)command.parameters[2]);
+    break;
+  case CEC_OPCODE_SET_MENU_LANGUAGE:
+    if (command.parameters.size == 3)
+    {
+      cec_menu_language language;
+      language.device = m_iLogicalAddress;
+      for (uint8_t iPtr = 0; iPtr < 3; iPtr++)
+        language.language[iPtr] = command.parameters[iPtr];
+      language.language[3] = 0;
+      SetMenuLanguage(language);
+    }
+    break;
+  case CEC_OPCODE_REPORT_POWER_STATUS:
+    if (command.parameters.size == 1)
+      SetPowerStatus((cec_power_status) command.parameters[0]);
+    break;
+  case CEC_OPCODE_CEC_VERSION:
+    if (command.parameters.size == 1)
+      SetCecVersion((cec_version) command.parameters[0]);
+    break;
+  default:
+    break;
+  }
+}
+
+int64_t CCECBusDevice::PollVendorId(void)
 {
   CLockObject lock(&m_transmitMutex);
-  if (m_iLastActive > 0 && m_iLogicalAddress != CECDEVICE_BROADCAST &&
-      m_vendor == CEC_VENDOR_UNKNOWN &&
-      GetTimeMs() - m_iLastCommandSent > 5000 &&
-      !m_processor->IsMonitoring())
-  {
-    CStdString strLog;
-    strLog.Format("<< requesting vendor ID of '%s' (%X)", GetLogicalAddressName(), m_iLogicalAddress);
-    AddLog(CEC_LOG_NOTICE, strLog);
-    m_iLastCommandSent = GetTimeMs();
+  if (m_iLastActive == 0 || m_iLogicalAddress == CECDEVICE_BROADCAST ||
+      m_vendor != CEC_VENDOR_UNKNOWN ||
+      m_processor->IsMonitoring())
+    return 0;
 
-    cec_command command;
+  /* a request was sent recently, e.g. by PrefetchDeviceInfo() */
+  int64_t iNow = GetTimeMs();
+  if (iNow - (int64_t) m_iLastCommandSent <= CEC_VENDOR_POLL_INTERVAL)
+    return (int64_t) m_iLastCommandSent + CEC_VENDOR_POLL_INTERVAL + 1;
+
+  LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< requesting vendor ID of '%s' (%X)", GetLogicalAddressName(), m_iLogicalAddress);
+  m_iLastCommandSent = iNow;
+
+  /* this is called from the processor thread, that also handles the reply. don't wait for it */
+  cec_command command;
+  cec_command::Format(command, GetMyLogicalAddress(), m_iLogicalAddress, CEC_OPCODE_GIVE_DEVICE_VENDOR_ID);
+  m_processor->TransmitAsync(command, NULL);
+
+  return iNow + CEC_VENDOR_POLL_INTERVAL + 1;
+}
+
+void CCECBusDevice::PrefetchDeviceInfo(void)
+{
+  CLockObject lock(&m_transmitMutex);
+  bool bRequestAddress(false), bRequestVendor(false);
+  {
+    CLockObject dataLock(&m_mutex);
+    bRequestAddress = m_iPhysicalAddress == 0xFFFF;
+    bRequestVendor  = m_vendor == CEC_VENDOR_UNKNOWN;
+  }
+
+  /* the replies are handled like any other frame, so nobody waits for them here */
+  cec_command command;
+  if (bRequestAddress)
+  {
+    cec_command::Format(command, GetMyLogicalAddress(), m_iLogicalAddress, CEC_OPCODE_GIVE_PHYSICAL_ADDRESS);
+    m_processor->TransmitAsync(command, NULL);
+  }
+
+  if (bRequestVendor)
+  {
     cec_command::Format(command, GetMyLogicalAddress(), m_iLogicalAddress, CEC_OPCODE_GIVE_DEVICE_VENDOR_ID);
-    if (m_processor->Transmit(command))
-      m_condition.Wait(&m_transmitMutex, 1000);
+    m_processor->TransmitAsync(command, NULL);
   }
+
+  /* don't let PollVendorId() send the same request again */
+  if (bRequestAddress || bRequestVendor)
+    m_iLastCommandSent = GetTimeMs();
+}
+
+void CCECBusDevice::LoadState(const cec_device_cache_entry &entry)
+{
+  if (!entry.iPresent || MyLogicalAddressContains(m_iLogicalAddress))
+    return;
+
+  SetVendorId(entry.iVendorId);
+
+  CLockObject lock(&m_mutex);
+  if (entry.iPhysicalAddress != 0xFFFF)
+  {
+    m_iPhysicalAddress = entry.iPhysicalAddress;
+    m_processor->GetTopology().SetPhysicalAddress(m_iLogicalAddress, m_iPhysicalAddress);
+  }
+  if (entry.strOSDName[0])
+    m_strDeviceName = entry.strOSDName;
+  m_cecVersion = (cec_version) entry.iCecVersion;
+
+  /* not verified yet */
+  for (unsigned int iPtr = 0; iPtr <= CEC_CACHED_MAX; iPtr++)
+    m_iUpdated[iPtr] = 0;
+}
+
+bool CCECBusDevice::SaveState(cec_device_cache_entry &entry)
+{
+  CLockObject lock(&m_mutex);
+  memset(&entry, 0, sizeof(entry));
+  entry.iPresent         = m_deviceStatus == CEC_DEVICE_STATUS_PRESENT ? 1 : 0;
+  entry.iPhysicalAddress = m_iPhysicalAddress;
+  entry.iVendorId        = (uint32_t) m_vendor;
+  entry.iCecVersion      = (uint8_t) m_cecVersion;
+  strncpy(entry.strOSDName, m_strDeviceName.c_str(), CEC_DEVICE_CACHE_OSD_NAME_SIZE - 1);
+  return entry.iPresent == 1;
 }
 
 bool CCECBusDevice::PowerOn(void)
 {
-   CStdString strLog;
-   strLog.Format("<< powering on '%s' (%X)", GetLogicalAddressName(), m_iLogicalAddress);
-   AddLog(CEC_LOG_DEBUG, strLog.c_str());
+   LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, "<< powering on '%s' (%X)", GetLogicalAddressName(), m_iLogicalAddress);
 
    cec_command command;
    cec_command::Format(command, GetMyLogicalAddress(), m_iLogicalAddress, CEC_OPCODE_IMAGE_VIEW_ON);
@@ -128,9 +284,7 @@ bool CCECBusDevice::PowerOn(void)
 
 bool CCECBusDevice::Standby(void)
 {
-  CStdString strLog;
-  strLog.Format("<< putting '%s' (%X) in standby mode", GetLogicalAddressName(), m_iLogicalAddress);
-  AddLog(CEC_LOG_DEBUG, strLog.c_str());
+  LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, "<< putting '%s' (%X) in standby mode", GetLogicalAddressName(), m_iLogicalAddress);
 
   cec_command command;
   cec_command::Format(command, GetMyLogicalAddress(), m_iLogicalAddress, CEC_OPCODE_STANDBY);
@@ -149,23 +303,35 @@ cec_version CCECBusDevice::GetCecVersion(void)
     RequestCecVersion();
     lock.Lock();
   }
+  else
+  {
+    lock.Leave();
+    RefreshAsync(CEC_CACHED_CEC_VERSION);
+    lock.Lock();
+  }
 
   return m_cecVersion;
 }
 
+cec_version CCECBusDevice::GetCachedCecVersion(int64_t *iAgeMs /* = NULL */)
+{
+  RefreshAsync(CEC_CACHED_CEC_VERSION);
+
+  CLockObject lock(&m_mutex);
+  if (iAgeMs)
+    *iAgeMs = GetAge(CEC_CACHED_CEC_VERSION);
+  return m_cecVersion;
+}
+
 bool CCECBusDevice::RequestCecVersion(void)
 {
   bool bReturn(false);
   if (!MyLogicalAddressContains(m_iLogicalAddress))
   {
-    CStdString strLog;
-    strLog.Format("<< requesting CEC version of '%s' (%X)", GetLogicalAddressName(), m_iLogicalAddress);
-    AddLog(CEC_LOG_NOTICE, strLog);
+    LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< requesting CEC version of '%s' (%X)", GetLogicalAddressName(), m_iLogicalAddress);
     cec_command command;
     cec_command::Format(command, GetMyLogicalAddress(), m_iLogicalAddress, CEC_OPCODE_GET_CEC_VERSION);
-    CLockObject lock(&m_transmitMutex);
-    if (m_processor->Transmit(command))
-      bReturn = m_condition.Wait(&m_transmitMutex, 1000);
+    bReturn = TransmitRequest(command);
   }
   return bReturn;
 }
@@ -184,6 +350,22 @@ cec_menu_language &CCECBusDevice::GetMenuLanguage(void)
     RequestMenuLanguage();
     lock.Lock();
   }
+  else
+  {
+    lock.Leave();
+    RefreshAsync(CEC_CACHED_MENU_LANGUAGE);
+    lock.Lock();
+  }
+  return m_menuLanguage;
+}
+
+cec_menu_language CCECBusDevice::GetCachedMenuLanguage(int64_t *iAgeMs /* = NULL */)
+{
+  RefreshAsync(CEC_CACHED_MENU_LANGUAGE);
+
+  CLockObject lock(&m_mutex);
+  if (iAgeMs)
+    *iAgeMs = GetAge(CEC_CACHED_MENU_LANGUAGE);
   return m_menuLanguage;
 }
 
@@ -192,14 +374,10 @@ bool CCECBusDevice::RequestMenuLanguage(void)
   bool bReturn(false);
   if (!MyLogicalAddressContains(m_iLogicalAddress))
   {
-    CStdString strLog;
-    strLog.Format("<< requesting menu language of '%s' (%X)", GetLogicalAddressName(), m_iLogicalAddress);
-    AddLog(CEC_LOG_NOTICE, strLog);
+    LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< requesting menu language of '%s' (%X)", GetLogicalAddressName(), m_iLogicalAddress);
     cec_command command;
     cec_command::Format(command, GetMyLogicalAddress(), m_iLogicalAddress, CEC_OPCODE_GET_MENU_LANGUAGE);
-    CLockObject lock(&m_transmitMutex);
-    if (m_processor->Transmit(command))
-      bReturn = m_condition.Wait(&m_transmitMutex, 1000);
+    bReturn = TransmitRequest(command);
   }
   return bReturn;
 }
@@ -236,14 +414,10 @@ bool CCECBusDevice::RequestPhysicalAddress(void)
   bool bReturn(false);
   if (!MyLogicalAddressContains(m_iLogicalAddress))
   {
-    CStdString strLog;
-    strLog.Format("<< requesting physical address of '%s' (%X)", GetLogicalAddressName(), m_iLogicalAddress);
-    AddLog(CEC_LOG_NOTICE, strLog);
+    LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< requesting physical address of '%s' (%X)", GetLogicalAddressName(), m_iLogicalAddress);
     cec_command command;
     cec_command::Format(command, GetMyLogicalAddress(), m_iLogicalAddress, CEC_OPCODE_GIVE_PHYSICAL_ADDRESS);
-    CLockObject lock(&m_transmitMutex);
-    if (m_processor->Transmit(command))
-      bReturn = m_condition.Wait(&m_transmitMutex, 1000);
+    bReturn = TransmitRequest(command);
   }
   return bReturn;
 }
@@ -257,6 +431,22 @@ cec_power_status CCECBusDevice::GetPowerStatus(void)
     RequestPowerStatus();
     lock.Lock();
   }
+  else
+  {
+    lock.Leave();
+    RefreshAsync(CEC_CACHED_POWER_STATUS);
+    lock.Lock();
+  }
+  return m_powerStatus;
+}
+
+cec_power_status CCECBusDevice::GetCachedPowerStatus(int64_t *iAgeMs /* = NULL */)
+{
+  RefreshAsync(CEC_CACHED_POWER_STATUS);
+
+  CLockObject lock(&m_mutex);
+  if (iAgeMs)
+    *iAgeMs = GetAge(CEC_CACHED_POWER_STATUS);
   return m_powerStatus;
 }
 
@@ -265,14 +455,10 @@ bool CCECBusDevice::RequestPowerStatus(void)
   bool bReturn(false);
   if (!MyLogicalAddressContains(m_iLogicalAddress))
   {
-    CStdString strLog;
-    strLog.Format("<< requesting power status of '%s' (%X)", GetLogicalAddressName(), m_iLogicalAddress);
-    AddLog(CEC_LOG_NOTICE, strLog);
+    LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< requesting power status of '%s' (%X)", GetLogicalAddressName(), m_iLogicalAddress);
     cec_command command;
     cec_command::Format(command, GetMyLogicalAddress(), m_iLogicalAddress, CEC_OPCODE_GIVE_DEVICE_POWER_STATUS);
-    CLockObject lock(&m_transmitMutex);
-    if (m_processor->Transmit(command))
-      bReturn = m_condition.Wait(&m_transmitMutex, 1000);
+    bReturn = TransmitRequest(command);
   }
   return bReturn;
 }
@@ -286,6 +472,22 @@ cec_vendor_id CCECBusDevice::GetVendorId(void)
     RequestVendorId();
     lock.Lock();
   }
+  else
+  {
+    lock.Leave();
+    RefreshAsync(CEC_CACHED_VENDOR_ID);
+    lock.Lock();
+  }
+  return m_vendor;
+}
+
+cec_vendor_id CCECBusDevice::GetCachedVendorId(int64_t *iAgeMs /* = NULL */)
+{
+  RefreshAsync(CEC_CACHED_VENDOR_ID);
+
+  CLockObject lock(&m_mutex);
+  if (iAgeMs)
+    *iAgeMs = GetAge(CEC_CACHED_VENDOR_ID);
   return m_vendor;
 }
 
@@ -294,15 +496,10 @@ bool CCECBusDevice::RequestVendorId(void)
   bool bReturn(false);
   if (!MyLogicalAddressContains(m_iLogicalAddress))
   {
-    CStdString strLog;
-    strLog.Format("<< requesting vendor ID of '%s' (%X)", GetLogicalAddressName(), m_iLogicalAddress);
-    AddLog(CEC_LOG_NOTICE, strLog);
+    LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< requesting vendor ID of '%s' (%X)", GetLogicalAddressName(), m_iLogicalAddress);
     cec_command command;
     cec_command::Format(command, GetMyLogicalAddress(), m_iLogicalAddress, CEC_OPCODE_GIVE_DEVICE_VENDOR_ID);
-
-    CLockObject lock(&m_transmitMutex);
-    if (m_processor->Transmit(command))
-      bReturn = m_condition.Wait(&m_transmitMutex, 1000);
+    bReturn = TransmitRequest(command);
   }
   return bReturn;
 }
@@ -317,10 +514,10 @@ bool CCECBusDevice::MyLogicalAddressContains(cec_logical_address address) const
   return m_processor->HasLogicalAddress(address);
 }
 
-cec_bus_device_status CCECBusDevice::GetStatus(void)
+cec_bus_device_status CCECBusDevice::GetStatus(bool bUpdate /* = true */)
 {
   CLockObject lock(&m_mutex);
-  if (m_deviceStatus == CEC_DEVICE_STATUS_UNKNOWN)
+  if (m_deviceStatus == CEC_DEVICE_STATUS_UNKNOWN && bUpdate)
   {
     if (m_processor->PollDevice(m_iLogicalAddress))
       m_deviceStatus = CEC_DEVICE_STATUS_PRESENT;
@@ -337,11 +534,15 @@ cec_bus_device_status CCECBusDevice::GetStatus(void)
 //@{
 void CCECBusDevice::SetCecVersion(const cec_version newVersion)
 {
-  m_cecVersion = newVersion;
+  {
+    CLockObject lock(&m_mutex);
+    m_iUpdated[CEC_CACHED_CEC_VERSION] = GetTimeMs();
+    if (m_cecVersion == newVersion)
+      return;
+    m_cecVersion = newVersion;
+  }
 
-  CStdString strLog;
-  strLog.Format("%s (%X): CEC version %s", GetLogicalAddressName(), m_iLogicalAddress, ToString(newVersion));
-  AddLog(CEC_LOG_DEBUG, strLog);
+  LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, "%s (%X): CEC version %s", GetLogicalAddressName(), m_iLogicalAddress, ToString(newVersion));
 }
 
 void CCECBusDevice::SetMenuLanguage(const cec_menu_language &language)
@@ -349,10 +550,9 @@ void CCECBusDevice::SetMenuLanguage(const cec_menu_language &language)
   CLockObject lock(&m_mutex);
   if (language.device == m_iLogicalAddress)
   {
-    CStdString strLog;
-    strLog.Format(">> %s (%X): menu language set to '%s'", GetLogicalAddressName(), m_iLogicalAddress, language.language);
-    m_processor->AddLog(CEC_LOG_DEBUG, strLog);
+    LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, ">> %s (%X): menu language set to '%s'", GetLogicalAddressName(), m_iLogicalAddress, language.language);
     m_menuLanguage = language;
+    m_iUpdated[CEC_CACHED_MENU_LANGUAGE] = GetTimeMs();
   }
 }
 
@@ -361,9 +561,7 @@ void CCECBusDevice::SetOSDName(CStdString strName)
   CLockObject lock(&m_mutex);
   if (m_strDeviceName != strName)
   {
-    CStdString strLog;
-    strLog.Format(">> %s (%X): osd name set to '%s'", GetLogicalAddressName(), m_iLogicalAddress, strName);
-    m_processor->AddLog(CEC_LOG_DEBUG, strLog);
+    LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, ">> %s (%X): osd name set to '%s'", GetLogicalAddressName(), m_iLogicalAddress, strName.c_str());
     m_strDeviceName = strName;
   }
 }
@@ -373,9 +571,7 @@ void CCECBusDevice::SetMenuState(const cec_menu_state state)
   CLockObject lock(&m_mutex);
   if (m_menuState != state)
   {
-    CStdString strLog;
-    strLog.Format(">> %s (%X): menu state set to '%s'", GetLogicalAddressName(), m_iLogicalAddress, ToString(m_menuState));
-    m_processor->AddLog(CEC_LOG_DEBUG, strLog);
+    LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, ">> %s (%X): menu state set to '%s'", GetLogicalAddressName(), m_iLogicalAddress, ToString(m_menuState));
     m_menuState = state;
   }
 }
@@ -383,7 +579,11 @@ void CCECBusDevice::SetMenuState(const cec_menu_state state)
 void CCECBusDevice::SetInactiveDevice(void)
 {
   CLockObject lock(&m_mutex);
-  m_bActiveSource = false;
+  if (m_bActiveSource)
+  {
+    m_bActiveSource = false;
+    StateChanged(CEC_STATE_CHANGE_ACTIVE_SOURCE);
+  }
 }
 
 void CCECBusDevice::SetActiveDevice(void)
@@ -394,28 +594,34 @@ void CCECBusDevice::SetActiveDevice(void)
     if (iPtr != m_iLogicalAddress)
       m_processor->m_busDevices[iPtr]->SetInactiveDevice();
 
-  m_bActiveSource = true;
-  m_powerStatus   = CEC_POWER_STATUS_ON;
+  if (m_powerStatus != CEC_POWER_STATUS_ON)
+  {
+    m_powerStatus = CEC_POWER_STATUS_ON;
+    StateChanged(CEC_STATE_CHANGE_POWER_STATUS);
+  }
+  m_iUpdated[CEC_CACHED_POWER_STATUS] = GetTimeMs();
+
+  if (!m_bActiveSource)
+  {
+    m_bActiveSource = true;
+    StateChanged(CEC_STATE_CHANGE_ACTIVE_SOURCE);
+  }
 }
 
 bool CCECBusDevice::TryLogicalAddress(void)
 {
-  CStdString strLog;
-  strLog.Format("trying logical address '%s'", GetLogicalAddressName());
-  AddLog(CEC_LOG_DEBUG, strLog);
+  LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, "trying logical address '%s'", GetLogicalAddressName());
 
   m_processor->SetAckMask(0x1 << m_iLogicalAddress);
   if (!TransmitPoll(m_iLogicalAddress))
   {
-    strLog.Format("using logical address '%s'", GetLogicalAddressName());
-    AddLog(CEC_LOG_NOTICE, strLog);
+    LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "using logical address '%s'", GetLogicalAddressName());
     SetDeviceStatus(CEC_DEVICE_STATUS_HANDLED_BY_LIBCEC);
 
     return true;
   }
 
-  strLog.Format("logical address '%s' already taken", GetLogicalAddressName());
-  AddLog(CEC_LOG_DEBUG, strLog);
+  LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, "logical address '%s' already taken", GetLogicalAddressName());
   SetDeviceStatus(CEC_DEVICE_STATUS_PRESENT);
   return false;
 }
@@ -429,12 +635,18 @@ void CCECBusDevice::SetDeviceStatus(const cec_bus_device_status newStatus)
     m_iStreamPath      = 0;
     m_powerStatus      = CEC_POWER_STATUS_UNKNOWN;
     m_vendor           = CEC_VENDOR_UNKNOWN;
+    SetHandler(m_processor->GetHandler(CEC_VENDOR_UNKNOWN));
     m_menuState        = CEC_MENU_STATE_ACTIVATED;
     m_bActiveSource    = false;
     m_iLastCommandSent = 0;
     m_iLastActive      = 0;
     m_cecVersion       = CEC_VERSION_UNKNOWN;
     m_deviceStatus     = newStatus;
+    for (unsigned int iPtr = 0; iPtr <= CEC_CACHED_MAX; iPtr++)
+    {
+      m_iUpdated[iPtr]          = 0;
+      m_iRefreshRequested[iPtr] = 0;
+    }
     break;
   case CEC_DEVICE_STATUS_HANDLED_BY_LIBCEC:
     m_iStreamPath      = 0;
@@ -446,6 +658,8 @@ void CCECBusDevice::SetDeviceStatus(const cec_bus_device_status newStatus)
     m_iLastActive      = 0;
     m_cecVersion       = CEC_VERSION_1_3A;
     m_deviceStatus     = newStatus;
+    m_iUpdated[CEC_CACHED_POWER_STATUS] = GetTimeMs();
+    m_iUpdated[CEC_CACHED_CEC_VERSION]  = GetTimeMs();
     break;
   case CEC_DEVICE_STATUS_PRESENT:
   case CEC_DEVICE_STATUS_NOT_PRESENT:
@@ -459,11 +673,10 @@ void CCECBusDevice::SetPhysicalAddress(uint16_t iNewAddress)
   CLockObject lock(&m_mutex);
   if (iNewAddress > 0 && m_iPhysicalAddress != iNewAddress)
   {
-    CStdString strLog;
-    strLog.Format(">> %s (%X): physical address changed from %04x to %04x", GetLogicalAddressName(), m_iLogicalAddress, m_iPhysicalAddress, iNewAddress);
-    AddLog(CEC_LOG_DEBUG, strLog.c_str());
+    LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, ">> %s (%X): physical address changed from %04x to %04x", GetLogicalAddressName(), m_iLogicalAddress, m_iPhysicalAddress, iNewAddress);
 
     m_iPhysicalAddress = iNewAddress;
+    m_processor->GetTopology().SetPhysicalAddress(m_iLogicalAddress, iNewAddress);
   }
 }
 
@@ -472,9 +685,7 @@ void CCECBusDevice::SetStreamPath(uint16_t iNewAddress, uint16_t iOldAddress /*
   CLockObject lock(&m_mutex);
   if (iNewAddress > 0)
   {
-    CStdString strLog;
-    strLog.Format(">> %s (%X): stream path changed from %04x to %04x", GetLogicalAddressName(), m_iLogicalAddress, iOldAddress == 0 ? m_iStreamPath : iOldAddress, iNewAddress);
-    AddLog(CEC_LOG_DEBUG, strLog.c_str());
+    LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, ">> %s (%X): stream path changed from %04x to %04x", GetLogicalAddressName(), m_iLogicalAddress, iOldAddress == 0 ? m_iStreamPath : iOldAddress, iNewAddress);
 
     m_iStreamPath = iNewAddress;
 
@@ -491,55 +702,25 @@ void CCECBusDevice::SetPowerStatus(const cec_power_status powerStatus)
   CLockObject lock(&m_mutex);
   if (m_powerStatus != powerStatus)
   {
-    CStdString strLog;
-    strLog.Format(">> %s (%X): power status changed from '%s' to '%s'", GetLogicalAddressName(), m_iLogicalAddress, ToString(m_powerStatus), ToString(powerStatus));
-    m_processor->AddLog(CEC_LOG_DEBUG, strLog);
+    LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, ">> %s (%X): power status changed from '%s' to '%s'", GetLogicalAddressName(), m_iLogicalAddress, ToString(m_powerStatus), ToString(powerStatus));
     m_powerStatus = powerStatus;
+    StateChanged(CEC_STATE_CHANGE_POWER_STATUS);
   }
+  m_iUpdated[CEC_CACHED_POWER_STATUS] = GetTimeMs();
 }
 
 void CCECBusDevice::SetVendorId(uint64_t iVendorId)
 {
   {
     CLockObject lock(&m_mutex);
+    m_iUpdated[CEC_CACHED_VENDOR_ID] = GetTimeMs();
+    if (m_vendor == (cec_vendor_id)iVendorId)
+      return;
     m_vendor = (cec_vendor_id)iVendorId;
-
-    switch (iVendorId)
-    {
-    case CEC_VENDOR_SAMSUNG:
-      if (m_handler->GetVendorId() != CEC_VENDOR_SAMSUNG)
-      {
-        delete m_handler;
-        m_handler = new CANCommandHandler(this);
-      }
-      break;
-    case CEC_VENDOR_LG:
-      if (m_handler->GetVendorId() != CEC_VENDOR_LG)
-      {
-        delete m_handler;
-        m_handler = new CSLCommandHandler(this);
-      }
-      break;
-    case CEC_VENDOR_PANASONIC:
-      if (m_handler->GetVendorId() != CEC_VENDOR_PANASONIC)
-      {
-        delete m_handler;
-        m_handler = new CVLCommandHandler(this);
-      }
-      break;
-    default:
-      if (m_handler->GetVendorId() != CEC_VENDOR_UNKNOWN)
-      {
-        delete m_handler;
-        m_handler = new CCECCommandHandler(this);
-      }
-      break;
-    }
+    SetHandler(m_processor->GetHandler(m_vendor));
   }
 
-  CStdString strLog;
-  strLog.Format("%s (%X): vendor = %s (%06x)", GetLogicalAddressName(), m_iLogicalAddress, GetVendorName(), m_vendor);
-  m_processor->AddLog(CEC_LOG_DEBUG, strLog.c_str());
+  LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, "%s (%X): vendor = %s (%06x)", GetLogicalAddressName(), m_iLogicalAddress, GetVendorName(), m_vendor);
 }
 //@}
 
@@ -550,15 +731,11 @@ bool CCECBusDevice::TransmitActiveSource(void)
   CLockObject lock(&m_mutex);
   if (m_powerStatus != CEC_POWER_STATUS_ON)
   {
-    CStdString strLog;
-    strLog.Format("<< %s (%X) is not powered on", GetLogicalAddressName(), m_iLogicalAddress);
-    AddLog(CEC_LOG_DEBUG, strLog);
+    LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, "<< %s (%X) is not powered on", GetLogicalAddressName(), m_iLogicalAddress);
   }
   else if (m_bActiveSource)
   {
-    CStdString strLog;
-    strLog.Format("<< %s (%X) -> broadcast (F): active source (%4x)", GetLogicalAddressName(), m_iLogicalAddress, m_iPhysicalAddress);
-    AddLog(CEC_LOG_NOTICE, strLog);
+    LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< %s (%X) -> broadcast (F): active source (%4x)", GetLogicalAddressName(), m_iLogicalAddress, m_iPhysicalAddress);
 
     cec_command command;
     cec_command::Format(command, m_iLogicalAddress, CECDEVICE_BROADCAST, CEC_OPCODE_ACTIVE_SOURCE);
@@ -570,9 +747,7 @@ bool CCECBusDevice::TransmitActiveSource(void)
   }
   else
   {
-    CStdString strLog;
-    strLog.Format("<< %s (%X) is not the active source", GetLogicalAddressName(), m_iLogicalAddress);
-    AddLog(CEC_LOG_DEBUG, strLog);
+    LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, "<< %s (%X) is not the active source", GetLogicalAddressName(), m_iLogicalAddress);
   }
 
   return false;
@@ -581,9 +756,7 @@ bool CCECBusDevice::TransmitActiveSource(void)
 bool CCECBusDevice::TransmitCECVersion(cec_logical_address dest)
 {
   CLockObject lock(&m_mutex);
-  CStdString strLog;
-  strLog.Format("<< %s (%X) -> %s (%X): cec version %s", GetLogicalAddressName(), m_iLogicalAddress, ToString(dest), dest, ToString(m_cecVersion));
-  AddLog(CEC_LOG_NOTICE, strLog);
+  LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< %s (%X) -> %s (%X): cec version %s", GetLogicalAddressName(), m_iLogicalAddress, ToString(dest), dest, ToString(m_cecVersion));
 
   cec_command command;
   cec_command::Format(command, m_iLogicalAddress, dest, CEC_OPCODE_CEC_VERSION);
@@ -595,9 +768,7 @@ bool CCECBusDevice::TransmitCECVersion(cec_logical_address dest)
 
 bool CCECBusDevice::TransmitInactiveView(void)
 {
-  CStdString strLog;
-  strLog.Format("<< %s (%X) -> broadcast (F): inactive view", GetLogicalAddressName(), m_iLogicalAddress);
-  AddLog(CEC_LOG_NOTICE, strLog);
+  LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< %s (%X) -> broadcast (F): inactive view", GetLogicalAddressName(), m_iLogicalAddress);
 
   cec_command command;
   cec_command::Format(command, m_iLogicalAddress, CECDEVICE_BROADCAST, CEC_OPCODE_INACTIVE_SOURCE);
@@ -609,9 +780,7 @@ bool CCECBusDevice::TransmitInactiveView(void)
 
 bool CCECBusDevice::TransmitMenuState(cec_logical_address dest)
 {
-  CStdString strLog;
-  strLog.Format("<< %s (%X) -> %s (%X): menu state '%s'", GetLogicalAddressName(), m_iLogicalAddress, ToString(dest), dest, ToString(m_menuState));
-  AddLog(CEC_LOG_NOTICE, strLog);
+  LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< %s (%X) -> %s (%X): menu state '%s'", GetLogicalAddressName(), m_iLogicalAddress, ToString(dest), dest, ToString(m_menuState));
 
   cec_command command;
   cec_command::Format(command, m_iLogicalAddress, dest, CEC_OPCODE_MENU_STATUS);
@@ -623,9 +792,7 @@ bool CCECBusDevice::TransmitMenuState(cec_logical_address dest)
 bool CCECBusDevice::TransmitOSDName(cec_logical_address dest)
 {
   CLockObject lock(&m_mutex);
-  CStdString strLog;
-  strLog.Format("<< %s (%X) -> %s (%X): OSD name '%s'", GetLogicalAddressName(), m_iLogicalAddress, ToString(dest), dest, m_strDeviceName.c_str());
-  AddLog(CEC_LOG_NOTICE, strLog.c_str());
+  LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< %s (%X) -> %s (%X): OSD name '%s'", GetLogicalAddressName(), m_iLogicalAddress, ToString(dest), dest, m_strDeviceName.c_str());
 
   cec_command command;
   cec_command::Format(command, m_iLogicalAddress, dest, CEC_OPCODE_SET_OSD_NAME);
@@ -639,9 +806,7 @@ bool CCECBusDevice::TransmitOSDName(cec_logical_address dest)
 bool CCECBusDevice::TransmitOSDString(cec_logical_address dest, cec_display_control duration, const char *strMessage)
 {
   CLockObject lock(&m_mutex);
-  CStdString strLog;
-  strLog.Format("<< %s (%X) -> %s (%X): display OSD message '%s'", GetLogicalAddressName(), m_iLogicalAddress, ToString(dest), dest, strMessage);
-  AddLog(CEC_LOG_NOTICE, strLog.c_str());
+  LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< %s (%X) -> %s (%X): display OSD message '%s'", GetLogicalAddressName(), m_iLogicalAddress, ToString(dest), dest, strMessage);
 
   cec_command command;
   cec_command::Format(command, m_iLogicalAddress, dest, CEC_OPCODE_SET_OSD_STRING);
@@ -660,9 +825,7 @@ bool CCECBusDevice::TransmitOSDString(cec_logical_address dest, cec_display_cont
 bool CCECBusDevice::TransmitPhysicalAddress(void)
 {
   CLockObject lock(&m_mutex);
-  CStdString strLog;
-  strLog.Format("<< %s (%X) -> broadcast (F): physical adddress %4x", GetLogicalAddressName(), m_iLogicalAddress, m_iPhysicalAddress);
-  AddLog(CEC_LOG_NOTICE, strLog.c_str());
+  LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< %s (%X) -> broadcast (F): physical adddress %4x", GetLogicalAddressName(), m_iLogicalAddress, m_iPhysicalAddress);
 
   cec_command command;
   cec_command::Format(command, m_iLogicalAddress, CECDEVICE_BROADCAST, CEC_OPCODE_REPORT_PHYSICAL_ADDRESS);
@@ -680,9 +843,7 @@ bool CCECBusDevice::TransmitPoll(cec_logical_address dest)
   if (dest == CECDEVICE_UNKNOWN)
     dest = m_iLogicalAddress;
 
-  CStdString strLog;
-  strLog.Format("<< %s (%X) -> %s (%X): POLL", GetLogicalAddressName(), m_iLogicalAddress, ToString(dest), dest);
-  AddLog(CEC_LOG_NOTICE, strLog.c_str());
+  LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< %s (%X) -> %s (%X): POLL", GetLogicalAddressName(), m_iLogicalAddress, ToString(dest), dest);
 
   cec_command command;
   cec_command::Format(command, m_iLogicalAddress, dest, CEC_OPCODE_NONE);
@@ -706,9 +867,7 @@ bool CCECBusDevice::TransmitPoll(cec_logical_address dest)
 bool CCECBusDevice::TransmitPowerState(cec_logical_address dest)
 {
   CLockObject lock(&m_mutex);
-  CStdString strLog;
-  strLog.Format("<< %s (%X) -> %s (%X): %s", GetLogicalAddressName(), m_iLogicalAddress, ToString(dest), dest, ToString(m_powerStatus));
-  AddLog(CEC_LOG_NOTICE, strLog.c_str());
+  LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< %s (%X) -> %s (%X): %s", GetLogicalAddressName(), m_iLogicalAddress, ToString(dest), dest, ToString(m_powerStatus));
 
   cec_command command;
   cec_command::Format(command, m_iLogicalAddress, dest, CEC_OPCODE_REPORT_POWER_STATUS);
@@ -723,9 +882,7 @@ bool CCECBusDevice::TransmitVendorID(cec_logical_address dest)
   CLockObject lock(&m_mutex);
   if (m_vendor == CEC_VENDOR_UNKNOWN)
   {
-    CStdString strLog;
-    strLog.Format("<< %s (%X) -> %s (%X): vendor id feature abort", GetLogicalAddressName(), m_iLogicalAddress, ToString(dest), dest);
-    AddLog(CEC_LOG_NOTICE, strLog);
+    LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< %s (%X) -> %s (%X): vendor id feature abort", GetLogicalAddressName(), m_iLogicalAddress, ToString(dest), dest);
 
     lock.Leave();
     m_processor->TransmitAbort(dest, CEC_OPCODE_GIVE_DEVICE_VENDOR_ID);
@@ -733,9 +890,7 @@ bool CCECBusDevice::TransmitVendorID(cec_logical_address dest)
   }
   else
   {
-    CStdString strLog;
-    strLog.Format("<< %s (%X) -> %s (%X): vendor id %s (%x)", GetLogicalAddressName(), m_iLogicalAddress, ToString(dest), dest, ToString(m_vendor), (uint64_t)m_vendor);
-    AddLog(CEC_LOG_NOTICE, strLog);
+    LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< %s (%X) -> %s (%X): vendor id %s (%x)", GetLogicalAddressName(), m_iLogicalAddress, ToString(dest), dest, ToString(m_vendor), (uint64_t)m_vendor);
 
     cec_command command;
     cec_command::Format(command, m_iLogicalAddress, CECDEVICE_BROADCAST, CEC_OPCODE_DEVICE_VENDOR_ID);
@@ -748,4 +903,65 @@ bool CCECBusDevice::TransmitVendorID(cec_logical_address dest)
     return m_processor->Transmit(command);
   }
 }
+
+void CCECBusDevice::SetHandler(CCECCommandHandler *handler)
+{
+  /* handlers are shared and only deleted with the processor, so a frame that is being handled
+     by the old handler can safely finish there */
+  AtomicBarrier();
+  m_handler = handler;
+}
+
+void CCECBusDevice::StateChanged(cec_state_change_type type)
+{
+  cec_state_change change;
+  change.type          = type;
+  change.address       = m_iLogicalAddress;
+  change.powerStatus   = m_powerStatus;
+  change.bActiveSource = m_bActiveSource ? 1 : 0;
+  m_processor->AddStateChange(change);
+}
+
+bool CCECBusDevice::TransmitRequest(const cec_command &command, uint32_t iTimeoutMs /* = 1000 */)
+{
+  /* register before transmitting, the reply can be handled before Transmit() returns */
+  uint32_t iHandle = m_responses.Register(command.opcode);
+  if (!m_processor->Transmit(command))
+  {
+    m_responses.Cancel(iHandle);
+    return false;
+  }
+
+  return m_responses.Wait(iHandle, iTimeoutMs);
+}
+
+void CCECBusDevice::RefreshAsync(cec_cached_value value)
+{
+  if (MyLogicalAddressContains(m_iLogicalAddress) || m_processor->IsMonitoring())
+    return;
+
+  {
+    CLockObject lock(&m_mutex);
+    int64_t iNow = GetTimeMs();
+    /* a request counts as a refresh, also when the device feature aborts it or doesn't answer at all. otherwise a
+       value that a device doesn't support would be requested again on every call */
+    if (m_deviceStatus == CEC_DEVICE_STATUS_NOT_PRESENT ||
+        (m_iUpdated[value] > 0 && iNow - m_iUpdated[value] < g_iCacheTTL[value]) ||
+        (m_iRefreshRequested[value] > 0 && iNow - m_iRefreshRequested[value] < g_iCacheTTL[value]))
+      return;
+    m_iRefreshRequested[value] = iNow;
+  }
+
+  LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, "<< refreshing '%s' (%X): %s", GetLogicalAddressName(), m_iLogicalAddress, ToString(g_cacheRequest[value]));
+
+  /* the reply is handled like any other frame and updates the cache */
+  cec_command command;
+  cec_command::Format(command, GetMyLogicalAddress(), m_iLogicalAddress, g_cacheRequest[value]);
+  m_processor->TransmitAsync(command, NULL);
+}
+
+int64_t CCECBusDevice::GetAge(cec_cached_value value) const
+{
+  return m_iUpdated[value] > 0 ? GetTimeMs() - m_iUpdated[value] : -1;
+}
 //@}
@@ -33,6 +33,8 @@
 
 #include <cectypes.h>
 #include "../platform/threads.h"
+#include "../DeviceCache.h"
+#include "../ResponseCorrelator.h"
 #include "../util/StdString.h"
 
 namespace CEC
@@ -40,6 +42,15 @@ namespace CEC
   class CCECProcessor;
   class CCECCommandHandler;
 
+  typedef enum cec_cached_value
+  {
+    CEC_CACHED_POWER_STATUS = 0,
+    CEC_CACHED_VENDOR_ID,
+    CEC_CACHED_CEC_VERSION,
+    CEC_CACHED_MENU_LANGUAGE,
+    CEC_CACHED_MAX = CEC_CACHED_MENU_LANGUAGE
+  } cec_cached_value;
+
   class CCECBusDevice
   {
     friend class CCECProcessor;
@@ -50,7 +61,33 @@ namespace CEC
 
     virtual void AddLog(cec_log_level level, const CStdString &strMessage);
     virtual bool HandleCommand(const cec_command &command);
-    virtual void PollVendorId(void);
+
+    /*!
+     * @brief Update the state of this device and the bus from a frame that this device sent, without replying to it.
+     *        Called for all traffic, also in monitoring mode.
+     * @param command The frame that was received from this device.
+     */
+    virtual void LearnFromCommand(const cec_command &command);
+    /*!
+     * @brief Request the vendor id of this device when it's active and the vendor is still unknown.
+     * @return The time at which this should be called again, or 0 when the vendor doesn't need to be polled.
+     */
+    virtual int64_t PollVendorId(void);
+    virtual void PrefetchDeviceInfo(void);
+
+    /*!
+     * @brief Use the values from the device cache until they are received from the device. They are handled like
+     *        expired values, so they're refreshed in the background when used.
+     * @param entry The cached state of this device.
+     */
+    virtual void LoadState(const cec_device_cache_entry &entry);
+
+    /*!
+     * @brief Store the known values of this device in the device cache.
+     * @param entry The entry to fill.
+     * @return True when this device is present, false otherwise.
+     */
+    virtual bool SaveState(cec_device_cache_entry &entry);
     virtual bool PowerOn(void);
     virtual bool Standby(void);
 
@@ -70,7 +107,20 @@ namespace CEC
     virtual cec_vendor_id         GetVendorId(void);
     virtual const char *          GetVendorName(void);
     virtual bool                  MyLogicalAddressContains(cec_logical_address address) const;
-    virtual cec_bus_device_status GetStatus(void);
+    virtual cec_bus_device_status GetStatus(bool bUpdate = true);
+
+    /*!
+     * @name Cached getters
+     * @brief Return the cached value without waiting for the bus. A value that isn't known or that expired is
+     *        requested from the device in the background.
+     * @param iAgeMs The time in ms since the value was received, or -1 when it isn't known. May be NULL.
+     */
+    //@{
+    virtual cec_version           GetCachedCecVersion(int64_t *iAgeMs = NULL);
+    virtual cec_menu_language     GetCachedMenuLanguage(int64_t *iAgeMs = NULL);
+    virtual cec_power_status      GetCachedPowerStatus(int64_t *iAgeMs = NULL);
+    virtual cec_vendor_id         GetCachedVendorId(int64_t *iAgeMs = NULL);
+    //@}
 
     bool RequestCecVersion(void);
     bool RequestMenuLanguage(void);
@@ -104,6 +154,34 @@ namespace CEC
     virtual bool TransmitVendorID(cec_logical_address dest);
 
   protected:
+    /*!
+     * @brief Transmit a request to this device and wait for the reply that the opcode table lists for it.
+     * @param command The request.
+     * @param iTimeoutMs The maximum time in ms to wait for the reply after the request was sent.
+     * @return True when the reply was received, false otherwise.
+     */
+    virtual bool TransmitRequest(const cec_command &command, uint32_t iTimeoutMs = 1000);
+
+    /*!
+     * @brief Request a cached value from the device without waiting for the reply, when it isn't known or expired.
+     *        A value is requested at most once per time to live, whether the device answers or not.
+     * @param value The value to refresh.
+     */
+    virtual void RefreshAsync(cec_cached_value value);
+
+    /*!
+     * @brief Use another command handler. Safe to call while a frame is being handled.
+     * @param handler The shared handler of the vendor of this device.
+     */
+    void         SetHandler(CCECCommandHandler *handler);
+
+    /*!
+     * @brief Pass the current power status and active source state of this device to the state change callback.
+     * @param type The state that changed.
+     */
+    void         StateChanged(cec_state_change_type type);
+    int64_t      GetAge(cec_cached_value value) const;
+
     cec_device_type       m_type;
     CStdString            m_strDeviceName;
     uint16_t              m_iPhysicalAddress;
@@ -112,7 +190,7 @@ namespace CEC
     cec_power_status      m_powerStatus;
     cec_menu_language     m_menuLanguage;
     CCECProcessor      *  m_processor;
-    CCECCommandHandler *  m_handler;
+    CCECCommandHandler * volatile m_handler;
     cec_vendor_id         m_vendor;
     cec_menu_state        m_menuState;
     bool                  m_bActiveSource;
@@ -122,6 +200,8 @@ namespace CEC
     cec_bus_device_status m_deviceStatus;
     CMutex                m_transmitMutex;
     CMutex                m_mutex;
-    CCondition            m_condition;
+    CResponseCorrelator   m_responses;
+    int64_t               m_iUpdated[CEC_CACHED_MAX + 1];
+    int64_t               m_iRefreshRequested[CEC_CACHED_MAX + 1];
   };
 };
@@ -33,6 +33,7 @@
 #include "CECPlaybackDevice.h"
 #include "../implementations/CECCommandHandler.h"
 #include "../CECProcessor.h"
+#include "../util/log.h"
 
 using namespace CEC;
 
@@ -48,9 +49,7 @@ void CCECPlaybackDevice::SetDeckStatus(cec_deck_info deckStatus)
 {
   if (m_deckStatus != deckStatus)
   {
-    CStdString strLog;
-    strLog.Format(">> %s (%X): deck status changed from '%s' to '%s'", GetLogicalAddressName(), m_iLogicalAddress, CCECCommandHandler::ToString(m_deckStatus), CCECCommandHandler::ToString(deckStatus));
-    AddLog(CEC_LOG_DEBUG, strLog.c_str());
+    LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, ">> %s (%X): deck status changed from '%s' to '%s'", GetLogicalAddressName(), m_iLogicalAddress, CCECCommandHandler::ToString(m_deckStatus), CCECCommandHandler::ToString(deckStatus));
 
     m_deckStatus = deckStatus;
   }
@@ -60,9 +59,7 @@ void CCECPlaybackDevice::SetDeckControlMode(cec_deck_control_mode mode)
 {
   if (m_deckControlMode != mode)
   {
-    CStdString strLog;
-    strLog.Format(">> %s (%X): deck control mode changed from '%s' to '%s'", GetLogicalAddressName(), m_iLogicalAddress, CCECCommandHandler::ToString(m_deckControlMode), CCECCommandHandler::ToString(mode));
-    AddLog(CEC_LOG_DEBUG, strLog.c_str());
+    LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, ">> %s (%X): deck control mode changed from '%s' to '%s'", GetLogicalAddressName(), m_iLogicalAddress, CCECCommandHandler::ToString(m_deckControlMode), CCECCommandHandler::ToString(mode));
 
     m_deckControlMode = mode;
   }
@@ -70,9 +67,7 @@ void CCECPlaybackDevice::SetDeckControlMode(cec_deck_control_mode mode)
 
 bool CCECPlaybackDevice::TransmitDeckStatus(cec_logical_address dest)
 {
-  CStdString strLog;
-  strLog.Format("<< %s (%X) -> %s (%X): deck status '%s'", GetLogicalAddressName(), m_iLogicalAddress, CCECCommandHandler::ToString(dest), dest, CCECCommandHandler::ToString(m_deckStatus));
-  AddLog(CEC_LOG_NOTICE, strLog);
+  LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, "<< %s (%X) -> %s (%X): deck status '%s'", GetLogicalAddressName(), m_iLogicalAddress, CCECCommandHandler::ToString(dest), dest, CCECCommandHandler::ToString(m_deckStatus));
 
   cec_command command;
   cec_command::Format(command, m_iLogicalAddress, dest, CEC_OPCODE_DECK_STATUS);
@@ -34,12 +34,22 @@
 #include "../devices/CECBusDevice.h"
 #include "../CECProcessor.h"
 #include "../util/StdString.h"
+#include "../util/log.h"
 
 using namespace CEC;
 
-CANCommandHandler::CANCommandHandler(CCECBusDevice *busDevice) :
-    CCECCommandHandler(busDevice)
+CCECOpcodeTable CANCommandHandler::m_opcodeTable(CANCommandHandler::RegisterHandlers);
+
+CANCommandHandler::CANCommandHandler(CCECProcessor *processor) :
+    CCECCommandHandler(processor)
+{
+}
+
+void CANCommandHandler::RegisterHandlers(CCECOpcodeTable &table)
 {
+  CCECCommandHandler::RegisterHandlers(table);
+  table.SetOverride(CEC_OPCODE_VENDOR_REMOTE_BUTTON_DOWN, static_cast<cec_opcode_handler>(&CANCommandHandler::HandleVendorRemoteButtonDown));
+  table.SetOverride(CEC_OPCODE_VENDOR_REMOTE_BUTTON_UP, static_cast<cec_opcode_handler>(&CANCommandHandler::HandleVendorRemoteButtonUp));
 }
 
 bool CANCommandHandler::HandleVendorRemoteButtonDown(const cec_command &command)
@@ -61,39 +71,17 @@ bool CANCommandHandler::HandleVendorRemoteButtonDown(const cec_command &command)
 
     if (key.keycode != CEC_USER_CONTROL_CODE_UNKNOWN)
     {
-      CStdString strLog;
-      strLog.Format("key pressed: %1x", key.keycode);
-      m_busDevice->AddLog(CEC_LOG_DEBUG, strLog);
+      LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, "key pressed: %1x", key.keycode);
 
-      m_busDevice->GetProcessor()->AddKey(key);
+      m_processor->AddKey(key);
     }
   }
 
   return true;
 }
 
-bool CANCommandHandler::HandleCommand(const cec_command &command)
+bool CANCommandHandler::HandleVendorRemoteButtonUp(const cec_command &command)
 {
-  bool bHandled(false);
-  if (m_busDevice->MyLogicalAddressContains(command.destination))
-  {
-    switch(command.opcode)
-    {
-    case CEC_OPCODE_VENDOR_REMOTE_BUTTON_DOWN:
-      bHandled = true;
-      HandleVendorRemoteButtonDown(command);
-      break;
-    case CEC_OPCODE_VENDOR_REMOTE_BUTTON_UP:
-      bHandled = true;
-      HandleUserControlRelease(command);
-      break;
-    default:
-      break;
-    }
-  }
-
-  if (!bHandled)
-    bHandled = CCECCommandHandler::HandleCommand(command);
-
-  return bHandled;
+  HandleUserControlRelease(command);
+  return true;
 }
@@ -38,14 +38,19 @@ namespace CEC
   class CANCommandHandler : public CCECCommandHandler
   {
   public:
-    CANCommandHandler(CCECBusDevice *busDevice);
+    CANCommandHandler(CCECProcessor *processor);
     virtual ~CANCommandHandler(void) {};
 
-    virtual bool HandleCommand(const cec_command &command);
-
     virtual cec_vendor_id GetVendorId(void) { return CEC_VENDOR_SAMSUNG; };
+    virtual CCECOpcodeTable &GetOpcodeTable(void) { return m_opcodeTable; }
 
   protected:
+    static void RegisterHandlers(CCECOpcodeTable &table);
+
     virtual bool HandleVendorRemoteButtonDown(const cec_command &command);
+    virtual bool HandleVendorRemoteButtonUp(const cec_command &command);
+
+  private:
+    static CCECOpcodeTable m_opcodeTable;
   };
 };
@@ -34,124 +34,88 @@
 #include "../devices/CECBusDevice.h"
 #include "../devices/CECAudioSystem.h"
 #include "../devices/CECPlaybackDevice.h"
+#include "../CECOpcodeInfo.h"
 #include "../CECProcessor.h"
+#include "../util/log.h"
 
 using namespace CEC;
 using namespace std;
 
-CCECCommandHandler::CCECCommandHandler(CCECBusDevice *busDevice)
+CCECOpcodeTable::CCECOpcodeTable(void (*registerHandlers)(CCECOpcodeTable &table))
+{
+  for (unsigned int iPtr = 0; iPtr < 256; iPtr++)
+  {
+    m_handlers[iPtr]  = NULL;
+    m_overrides[iPtr] = NULL;
+  }
+
+  registerHandlers(*this);
+}
+
+CCECOpcodeTable CCECCommandHandler::m_opcodeTable(CCECCommandHandler::RegisterHandlers);
+
+CCECCommandHandler::CCECCommandHandler(CCECProcessor *processor) :
+    m_processor(processor)
 {
-  m_busDevice = busDevice;
+}
+
+void CCECCommandHandler::RegisterHandlers(CCECOpcodeTable &table)
+{
+  table.SetHandler(CEC_OPCODE_REPORT_POWER_STATUS, &CCECCommandHandler::HandleReportPowerStatus);
+  table.SetHandler(CEC_OPCODE_CEC_VERSION, &CCECCommandHandler::HandleDeviceCecVersion);
+  table.SetHandler(CEC_OPCODE_SET_MENU_LANGUAGE, &CCECCommandHandler::HandleSetMenuLanguage);
+  table.SetHandler(CEC_OPCODE_GIVE_PHYSICAL_ADDRESS, &CCECCommandHandler::HandleGivePhysicalAddress);
+  table.SetHandler(CEC_OPCODE_GIVE_OSD_NAME, &CCECCommandHandler::HandleGiveOSDName);
+  table.SetHandler(CEC_OPCODE_GIVE_DEVICE_VENDOR_ID, &CCECCommandHandler::HandleGiveDeviceVendorId);
+  table.SetHandler(CEC_OPCODE_DEVICE_VENDOR_ID, &CCECCommandHandler::HandleDeviceVendorId);
+  table.SetHandler(CEC_OPCODE_VENDOR_COMMAND_WITH_ID, &CCECCommandHandler::HandleDeviceVendorCommandWithId);
+  table.SetHandler(CEC_OPCODE_GIVE_DECK_STATUS, &CCECCommandHandler::HandleGiveDeckStatus);
+  table.SetHandler(CEC_OPCODE_DECK_CONTROL, &CCECCommandHandler::HandleDeckControl);
+  table.SetHandler(CEC_OPCODE_MENU_REQUEST, &CCECCommandHandler::HandleMenuRequest);
+  table.SetHandler(CEC_OPCODE_GIVE_DEVICE_POWER_STATUS, &CCECCommandHandler::HandleGiveDevicePowerStatus);
+  table.SetHandler(CEC_OPCODE_GET_CEC_VERSION, &CCECCommandHandler::HandleGetCecVersion);
+  table.SetHandler(CEC_OPCODE_USER_CONTROL_PRESSED, &CCECCommandHandler::HandleUserControlPressed);
+  table.SetHandler(CEC_OPCODE_USER_CONTROL_RELEASE, &CCECCommandHandler::HandleUserControlRelease);
+  table.SetHandler(CEC_OPCODE_GIVE_AUDIO_STATUS, &CCECCommandHandler::HandleGiveAudioStatus);
+  table.SetHandler(CEC_OPCODE_GIVE_SYSTEM_AUDIO_MODE_STATUS, &CCECCommandHandler::HandleGiveSystemAudioModeStatus);
+  table.SetHandler(CEC_OPCODE_SYSTEM_AUDIO_MODE_REQUEST, &CCECCommandHandler::HandleSetSystemAudioModeRequest);
+  table.SetHandler(CEC_OPCODE_REQUEST_ACTIVE_SOURCE, &CCECCommandHandler::HandleRequestActiveSource);
+  table.SetHandler(CEC_OPCODE_SET_STREAM_PATH, &CCECCommandHandler::HandleSetStreamPath);
+  table.SetHandler(CEC_OPCODE_ROUTING_CHANGE, &CCECCommandHandler::HandleRoutingChange);
+  table.SetHandler(CEC_OPCODE_ROUTING_INFORMATION, &CCECCommandHandler::HandleRoutingInformation);
+  table.SetHandler(CEC_OPCODE_STANDBY, &CCECCommandHandler::HandleStandby);
+  table.SetHandler(CEC_OPCODE_ACTIVE_SOURCE, &CCECCommandHandler::HandleActiveSource);
+  table.SetHandler(CEC_OPCODE_REPORT_PHYSICAL_ADDRESS, &CCECCommandHandler::HandleReportPhysicalAddress);
+  table.SetHandler(CEC_OPCODE_REPORT_AUDIO_STATUS, &CCECCommandHandler::HandleReportAudioStatus);
+  table.SetHandler(CEC_OPCODE_SYSTEM_AUDIO_MODE_STATUS, &CCECCommandHandler::HandleSystemAudioStatus);
+  table.SetHandler(CEC_OPCODE_SET_OSD_NAME, &CCECCommandHandler::HandleSetOSDName);
+  table.SetHandler(CEC_OPCODE_IMAGE_VIEW_ON, &CCECCommandHandler::HandleImageViewOn);
+  table.SetHandler(CEC_OPCODE_TEXT_VIEW_ON, &CCECCommandHandler::HandleTextViewOn);
 }
 
 bool CCECCommandHandler::HandleCommand(const cec_command &command)
 {
   bool bHandled(true);
+  CCECOpcodeTable &table = GetOpcodeTable();
 
-  CStdString strLog;
-  strLog.Format(">> %s (%X) -> %s (%X): %s (%2X)", ToString(command.initiator), command.initiator, ToString(command.destination), command.destination, ToString(command.opcode), command.opcode);
-  m_busDevice->AddLog(CEC_LOG_NOTICE, strLog);
-
-  switch(command.opcode)
-  {
-  case CEC_OPCODE_REPORT_POWER_STATUS:
-    HandleReportPowerStatus(command);
-    break;
-  case CEC_OPCODE_CEC_VERSION:
-    HandleDeviceCecVersion(command);
-    break;
-  case CEC_OPCODE_SET_MENU_LANGUAGE:
-    HandleSetMenuLanguage(command);
-    break;
-  case CEC_OPCODE_GIVE_PHYSICAL_ADDRESS:
-    HandleGivePhysicalAddress(command);
-    break;
-  case CEC_OPCODE_GIVE_OSD_NAME:
-     HandleGiveOSDName(command);
-    break;
-  case CEC_OPCODE_GIVE_DEVICE_VENDOR_ID:
-    HandleGiveDeviceVendorId(command);
-    break;
-  case CEC_OPCODE_DEVICE_VENDOR_ID:
-    HandleDeviceVendorId(command);
-    break;
-  case CEC_OPCODE_VENDOR_COMMAND_WITH_ID:
-    HandleDeviceVendorCommandWithId(command);
-    break;
-  case CEC_OPCODE_GIVE_DECK_STATUS:
-    HandleGiveDeckStatus(command);
-    break;
-  case CEC_OPCODE_DECK_CONTROL:
-    HandleDeckControl(command);
-    break;
-  case CEC_OPCODE_MENU_REQUEST:
-    HandleMenuRequest(command);
-    break;
-  case CEC_OPCODE_GIVE_DEVICE_POWER_STATUS:
-    HandleGiveDevicePowerStatus(command);
-    break;
-  case CEC_OPCODE_GET_CEC_VERSION:
-    HandleGetCecVersion(command);
-    break;
-  case CEC_OPCODE_USER_CONTROL_PRESSED:
-    HandleUserControlPressed(command);
-    break;
-  case CEC_OPCODE_USER_CONTROL_RELEASE:
-    HandleUserControlRelease(command);
-    break;
-  case CEC_OPCODE_GIVE_AUDIO_STATUS:
-    HandleGiveAudioStatus(command);
-    break;
-  case CEC_OPCODE_GIVE_SYSTEM_AUDIO_MODE_STATUS:
-    HandleGiveSystemAudioModeStatus(command);
-    break;
-  case CEC_OPCODE_SYSTEM_AUDIO_MODE_REQUEST:
-    HandleSetSystemAudioModeRequest(command);
-    break;
-  case CEC_OPCODE_REQUEST_ACTIVE_SOURCE:
-    HandleRequestActiveSource(command);
-    break;
-  case CEC_OPCODE_SET_STREAM_PATH:
-    HandleSetStreamPath(command);
-    break;
-  case CEC_OPCODE_ROUTING_CHANGE:
-    HandleRoutingChange(command);
-    break;
-  case CEC_OPCODE_ROUTING_INFORMATION:
-    HandleRoutingInformation(command);
-    break;
-  case CEC_OPCODE_STANDBY:
-    HandleStandby(command);
-    break;
-  case CEC_OPCODE_ACTIVE_SOURCE:
-    HandleActiveSource(command);
-    break;
-  case CEC_OPCODE_REPORT_PHYSICAL_ADDRESS:
-    HandleReportPhysicalAddress(command);
-    break;
-  case CEC_OPCODE_REPORT_AUDIO_STATUS:
-    HandleReportAudioStatus(command);
-    break;
-  case CEC_OPCODE_SYSTEM_AUDIO_MODE_STATUS:
-    HandleSystemAudioStatus(command);
-    break;
-  case CEC_OPCODE_SET_OSD_NAME:
-    HandleSetOSDName(command);
-    break;
-  case CEC_OPCODE_IMAGE_VIEW_ON:
-    HandleImageViewOn(command);
-    break;
-  case CEC_OPCODE_TEXT_VIEW_ON:
-    HandleTextViewOn(command);
-    break;
-  default:
+  /* vendor specific handling of commands that are sent to us */
+  cec_opcode_handler handler = table.GetOverride(command.opcode);
+  if (handler && m_processor->HasLogicalAddress(command.destination) && (this->*handler)(command))
+    return true;
+
+  LIB_CEC_LOG(m_processor, CEC_LOG_NOTICE, ">> %s (%X) -> %s (%X): %s (%2X)", ToString(command.initiator), command.initiator, ToString(command.destination), command.destination, ToString(command.opcode), command.opcode);
+
+  handler = table.GetHandler(command.opcode);
+  if (handler)
+    (this->*handler)(command);
+  else
+  {
     UnhandledCommand(command);
     bHandled = false;
-    break;
   }
 
-  if (command.destination == CECDEVICE_BROADCAST || m_busDevice->MyLogicalAddressContains(command.destination))
-    m_busDevice->GetProcessor()->AddCommand(command);
+  if (command.destination == CECDEVICE_BROADCAST || m_processor->HasLogicalAddress(command.destination))
+    m_processor->AddCommand(command);
 
   return bHandled;
 }
@@ -161,7 +125,7 @@ bool CCECCommandHandler::HandleActiveSource(const cec_command &command)
   if (command.parameters.size == 2)
   {
     uint16_t iAddress = ((uint16_t)command.parameters[0] << 8) | ((uint16_t)command.parameters[1]);
-    return m_busDevice->GetProcessor()->SetStreamPath(iAddress);
+    return m_processor->SetStreamPath(iAddress);
   }
 
   return true;
@@ -193,8 +157,8 @@ bool CCECCommandHandler::HandleDeviceCecVersion(const cec_command &command)
 
 bool CCECCommandHandler::HandleDeviceVendorCommandWithId(const cec_command &command)
 {
-  if (m_busDevice->MyLogicalAddressContains(command.destination))
-    m_busDevice->GetProcessor()->TransmitAbort(command.initiator, command.opcode, CEC_ABORT_REASON_REFUSED);
+  if (m_processor->HasLogicalAddress(command.destination))
+    m_processor->TransmitAbort(command.initiator, command.opcode, CEC_ABORT_REASON_REFUSED);
 
   return true;
 }
@@ -207,7 +171,7 @@ bool CCECCommandHandler::HandleDeviceVendorId(const cec_command &command)
 
 bool CCECCommandHandler::HandleGetCecVersion(const cec_command &command)
 {
-  if (m_busDevice->MyLogicalAddressContains(command.destination))
+  if (m_processor->HasLogicalAddress(command.destination))
   {
     CCECBusDevice *device = GetDevice(command.destination);
     if (device)
@@ -219,7 +183,7 @@ bool CCECCommandHandler::HandleGetCecVersion(const cec_command &command)
 
 bool CCECCommandHandler::HandleGiveAudioStatus(const cec_command &command)
 {
-  if (m_busDevice->MyLogicalAddressContains(command.destination))
+  if (m_processor->HasLogicalAddress(command.destination))
   {
     CCECBusDevice *device = GetDevice(command.destination);
     if (device && device->GetType() == CEC_DEVICE_TYPE_AUDIO_SYSTEM)
@@ -231,7 +195,7 @@ bool CCECCommandHandler::HandleGiveAudioStatus(const cec_command &command)
 
 bool CCECCommandHandler::HandleGiveDeckStatus(const cec_command &command)
 {
-  if (m_busDevice->MyLogicalAddressContains(command.destination))
+  if (m_processor->HasLogicalAddress(command.destination))
   {
     CCECBusDevice *device = GetDevice(command.destination);
     if (device && (device->GetType() == CEC_DEVICE_TYPE_PLAYBACK_DEVICE || device->GetType() == CEC_DEVICE_TYPE_RECORDING_DEVICE))
@@ -243,7 +207,7 @@ bool CCECCommandHandler::HandleGiveDeckStatus(const cec_command &command)
 
 bool CCECCommandHandler::HandleGiveDevicePowerStatus(const cec_command &command)
 {
-  if (m_busDevice->MyLogicalAddressContains(command.destination))
+  if (m_processor->HasLogicalAddress(command.destination))
   {
     CCECBusDevice *device = GetDevice(command.destination);
     if (device)
@@ -255,7 +219,7 @@ bool CCECCommandHandler::HandleGiveDevicePowerStatus(const cec_command &command)
 
 bool CCECCommandHandler::HandleGiveDeviceVendorId(const cec_command &command)
 {
-  if (m_busDevice->MyLogicalAddressContains(command.destination))
+  if (m_processor->HasLogicalAddress(command.destination))
   {
     CCECBusDevice *device = GetDevice(command.destination);
     if (device)
@@ -267,7 +231,7 @@ bool CCECCommandHandler::HandleGiveDeviceVendorId(const cec_command &command)
 
 bool CCECCommandHandler::HandleGiveOSDName(const cec_command &command)
 {
-  if (m_busDevice->MyLogicalAddressContains(command.destination))
+  if (m_processor->HasLogicalAddress(command.destination))
   {
     CCECBusDevice *device = GetDevice(command.destination);
     if (device)
@@ -279,7 +243,7 @@ bool CCECCommandHandler::HandleGiveOSDName(const cec_command &command)
 
 bool CCECCommandHandler::HandleGivePhysicalAddress(const cec_command &command)
 {
-  if (m_busDevice->MyLogicalAddressContains(command.destination))
+  if (m_processor->HasLogicalAddress(command.destination))
   {
     CCECBusDevice *device = GetDevice(command.destination);
     if (device)
@@ -291,7 +255,7 @@ bool CCECCommandHandler::HandleGivePhysicalAddress(const cec_command &command)
 
 bool CCECCommandHandler::HandleGiveSystemAudioModeStatus(const cec_command &command)
 {
-  if (m_busDevice->MyLogicalAddressContains(command.destination))
+  if (m_processor->HasLogicalAddress(command.destination))
   {
     CCECBusDevice *device = GetDevice(command.destination);
     if (device && device->GetType() == CEC_DEVICE_TYPE_AUDIO_SYSTEM)
@@ -303,13 +267,13 @@ bool CCECCommandHandler::HandleGiveSystemAudioModeStatus(const cec_command &comm
 
 bool CCECCommandHandler::HandleImageViewOn(const cec_command &command)
 {
-  m_busDevice->GetProcessor()->SetActiveSource(command.initiator);
+  m_processor->SetActiveSource(command.initiator);
   return true;
 }
 
 bool CCECCommandHandler::HandleMenuRequest(const cec_command &command)
 {
-  if (m_busDevice->MyLogicalAddressContains(command.destination))
+  if (m_processor->HasLogicalAddress(command.destination))
   {
     if (command.parameters[0] == CEC_MENU_REQUEST_TYPE_QUERY)
     {
@@ -359,9 +323,7 @@ bool CCECCommandHandler::HandleReportPowerStatus(const cec_command &command)
 
 bool CCECCommandHandler::HandleRequestActiveSource(const cec_command &command)
 {
-  CStdString strLog;
-  strLog.Format(">> %i requests active source", (uint8_t) command.initiator);
-  m_busDevice->AddLog(CEC_LOG_DEBUG, strLog.c_str());
+  LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, ">> %i requests active source", (uint8_t) command.initiator);
 
   vector<CCECBusDevice *> devices;
   for (int iDevicePtr = (int)GetMyDevices(devices)-1; iDevicePtr >=0; iDevicePtr--)
@@ -380,6 +342,21 @@ bool CCECCommandHandler::HandleRoutingChange(const cec_command &command)
     CCECBusDevice *device = GetDevice(command.initiator);
     if (device)
       device->SetStreamPath(iNewAddress, iOldAddress);
+
+    uint16_t path[CEC_TOPOLOGY_MAX_PATH];
+    uint8_t iHops = m_processor->IsLogLevelEnabled(CEC_LOG_DEBUG) ?
+        CHDMITopology::GetPath(iOldAddress, iNewAddress, path, CEC_TOPOLOGY_MAX_PATH) : 0;
+    if (iHops > 0)
+    {
+      CStdString strLog;
+      strLog.Format(">> %i changed the route:", command.initiator);
+      for (uint8_t iPtr = 0; iPtr < iHops; iPtr++)
+        strLog.AppendFormat(" %04x", path[iPtr]);
+      m_processor->AddLog(CEC_LOG_DEBUG, strLog);
+    }
+
+    /* the device at the new address is the active source now */
+    m_processor->SetStreamPath(iNewAddress);
   }
   return true;
 }
@@ -389,7 +366,7 @@ bool CCECCommandHandler::HandleRoutingInformation(const cec_command &command)
   if (command.parameters.size == 2)
   {
     uint16_t iNewAddress = ((uint16_t)command.parameters[0] << 8) | ((uint16_t)command.parameters[1]);
-    m_busDevice->GetProcessor()->SetStreamPath(iNewAddress);
+    m_processor->SetStreamPath(iNewAddress);
   }
 
   return false;
@@ -440,17 +417,17 @@ bool CCECCommandHandler::HandleSetStreamPath(const cec_command &command)
   if (command.parameters.size >= 2)
   {
     uint16_t iStreamAddress = ((uint16_t)command.parameters[0] << 8) | ((uint16_t)command.parameters[1]);
-    CStdString strLog;
-    strLog.Format(">> %i sets stream path to physical address %04x", command.initiator, iStreamAddress);
-    m_busDevice->AddLog(CEC_LOG_DEBUG, strLog.c_str());
+    LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, ">> %i sets stream path to physical address %04x", command.initiator, iStreamAddress);
 
-    if (m_busDevice->GetProcessor()->SetStreamPath(iStreamAddress))
+    if (m_processor->SetStreamPath(iStreamAddress))
     {
       CCECBusDevice *device = GetDeviceByPhysicalAddress(iStreamAddress);
       if (device)
       {
-        return device->TransmitActiveSource() &&
-            device->TransmitMenuState(command.initiator);
+        /* both replies are queued while a command is handled, so the menu state can't wait for the active source
+           to be acked */
+        bool bReturn = device->TransmitActiveSource();
+        return device->TransmitMenuState(command.initiator) && bReturn;
       }
     }
   }
@@ -459,7 +436,7 @@ bool CCECCommandHandler::HandleSetStreamPath(const cec_command &command)
 
 bool CCECCommandHandler::HandleSetSystemAudioModeRequest(const cec_command &command)
 {
-  if (m_busDevice->MyLogicalAddressContains(command.destination) && command.parameters.size >= 1)
+  if (m_processor->HasLogicalAddress(command.destination) && command.parameters.size >= 1)
   {
     CCECBusDevice *device = GetDevice(command.destination);
     if (device&& device->GetType() == CEC_DEVICE_TYPE_AUDIO_SYSTEM)
@@ -491,21 +468,19 @@ bool CCECCommandHandler::HandleSystemAudioStatus(const cec_command &command)
 
 bool CCECCommandHandler::HandleTextViewOn(const cec_command &command)
 {
-  m_busDevice->GetProcessor()->SetActiveSource(command.initiator);
+  m_processor->SetActiveSource(command.initiator);
   return true;
 }
 
 bool CCECCommandHandler::HandleUserControlPressed(const cec_command &command)
 {
-  if (m_busDevice->MyLogicalAddressContains(command.destination) && command.parameters.size > 0)
+  if (m_processor->HasLogicalAddress(command.destination) && command.parameters.size > 0)
   {
-    m_busDevice->GetProcessor()->AddKey();
+    m_processor->AddKey();
 
     if (command.parameters[0] <= CEC_USER_CONTROL_CODE_MAX)
     {
-      CStdString strLog;
-      strLog.Format("key pressed: %x", command.parameters[0]);
-      m_busDevice->AddLog(CEC_LOG_DEBUG, strLog.c_str());
+      LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, "key pressed: %x", command.parameters[0]);
 
       if (command.parameters[0] == CEC_USER_CONTROL_CODE_POWER ||
           command.parameters[0] == CEC_USER_CONTROL_CODE_POWER_ON_FUNCTION)
@@ -515,7 +490,7 @@ bool CCECCommandHandler::HandleUserControlPressed(const cec_command &command)
           device->SetPowerStatus(CEC_POWER_STATUS_ON);
       }
 
-      m_busDevice->GetProcessor()->SetCurrentButton((cec_user_control_code) command.parameters[0]);
+      m_processor->SetCurrentButton((cec_user_control_code) command.parameters[0]);
       return true;
     }
   }
@@ -524,24 +499,22 @@ bool CCECCommandHandler::HandleUserControlPressed(const cec_command &command)
 
 bool CCECCommandHandler::HandleUserControlRelease(const cec_command &command)
 {
-  if (m_busDevice->MyLogicalAddressContains(command.destination))
-    m_busDevice->GetProcessor()->AddKey();
+  if (m_processor->HasLogicalAddress(command.destination))
+    m_processor->AddKey();
 
   return true;
 }
 
 void CCECCommandHandler::UnhandledCommand(const cec_command &command)
 {
-  CStdString strLog;
-  strLog.Format("unhandled command with opcode %02x from address %d", command.opcode, command.initiator);
-  m_busDevice->AddLog(CEC_LOG_DEBUG, strLog);
+  LIB_CEC_LOG(m_processor, CEC_LOG_DEBUG, "unhandled command with opcode %02x from address %d", command.opcode, command.initiator);
 }
 
 unsigned int CCECCommandHandler::GetMyDevices(vector<CCECBusDevice *> &devices) const
 {
   unsigned int iReturn(0);
 
-  cec_logical_addresses addresses = m_busDevice->GetProcessor()->GetLogicalAddresses();
+  cec_logical_addresses addresses = m_processor->GetLogicalAddresses();
   for (uint8_t iPtr = 0; iPtr < 16; iPtr++)
   {
     if (addresses[iPtr])
@@ -559,26 +532,26 @@ CCECBusDevice *CCECCommandHandler::GetDevice(cec_logical_address iLogicalAddress
   CCECBusDevice *device = NULL;
 
   if (iLogicalAddress >= CECDEVICE_TV && iLogicalAddress <= CECDEVICE_BROADCAST)
-    device = m_busDevice->GetProcessor()->m_busDevices[iLogicalAddress];
+    device = m_processor->m_busDevices[iLogicalAddress];
 
   return device;
 }
 
 CCECBusDevice *CCECCommandHandler::GetDeviceByPhysicalAddress(uint16_t iPhysicalAddress) const
 {
-  return m_busDevice->GetProcessor()->GetDeviceByPhysicalAddress(iPhysicalAddress);
+  return m_processor->GetDeviceByPhysicalAddress(iPhysicalAddress);
 }
 
 CCECBusDevice *CCECCommandHandler::GetDeviceByType(cec_device_type type) const
 {
-  return m_busDevice->GetProcessor()->GetDeviceByType(type);
+  return m_processor->GetDeviceByType(type);
 }
 
 void CCECCommandHandler::SetVendorId(const cec_command &command)
 {
   if (command.parameters.size < 3)
   {
-    m_busDevice->AddLog(CEC_LOG_WARNING, "invalid vendor ID received");
+    m_processor->AddLog(CEC_LOG_WARNING, "invalid vendor ID received");
     return;
   }
 
@@ -593,18 +566,9 @@ void CCECCommandHandler::SetVendorId(const cec_command &command)
 
 void CCECCommandHandler::SetPhysicalAddress(cec_logical_address iAddress, uint16_t iNewAddress)
 {
-  if (!m_busDevice->MyLogicalAddressContains(iAddress))
-  {
-    bool bOurAddress(m_busDevice->GetProcessor()->GetPhysicalAddress() == iNewAddress);
+  /* the processor detects a new address when this is the same as ours */
+  if (!m_processor->HasLogicalAddress(iAddress))
     GetDevice(iAddress)->SetPhysicalAddress(iNewAddress);
-    if (bOurAddress)
-    {
-      /* another device reported the same physical address as ours
-       * since we don't have physical address detection yet, we'll just use the
-       * given address, increased by 0x100 for now */
-      m_busDevice->GetProcessor()->SetPhysicalAddress(iNewAddress + 0x100);
-    }
-  }
 }
 
 const char *CCECCommandHandler::ToString(const cec_menu_state state)
@@ -755,135 +719,7 @@ const char *CCECCommandHandler::ToString(const cec_deck_info status)
 
 const char *CCECCommandHandler::ToString(const cec_opcode opcode)
 {
-  switch (opcode)
-  {
-  case CEC_OPCODE_ACTIVE_SOURCE:
-    return "active source";
-  case CEC_OPCODE_IMAGE_VIEW_ON:
-    return "image view on";
-  case CEC_OPCODE_TEXT_VIEW_ON:
-    return "text view on";
-  case CEC_OPCODE_INACTIVE_SOURCE:
-    return "inactive source";
-  case CEC_OPCODE_REQUEST_ACTIVE_SOURCE:
-    return "request active source";
-  case CEC_OPCODE_ROUTING_CHANGE:
-    return "routing change";
-  case CEC_OPCODE_ROUTING_INFORMATION:
-    return "routing information";
-  case CEC_OPCODE_SET_STREAM_PATH:
-    return "set stream path";
-  case CEC_OPCODE_STANDBY:
-    return "standby";
-  case CEC_OPCODE_RECORD_OFF:
-    return "record off";
-  case CEC_OPCODE_RECORD_ON:
-    return "record on";
-  case CEC_OPCODE_RECORD_STATUS:
-    return "record status";
-  case CEC_OPCODE_RECORD_TV_SCREEN:
-    return "record tv screen";
-  case CEC_OPCODE_CLEAR_ANALOGUE_TIMER:
-    return "clear analogue timer";
-  case CEC_OPCODE_CLEAR_DIGITAL_TIMER:
-    return "clear digital timer";
-  case CEC_OPCODE_CLEAR_EXTERNAL_TIMER:
-    return "clear external timer";
-  case CEC_OPCODE_SET_ANALOGUE_TIMER:
-    return "set analogue timer";
-  case CEC_OPCODE_SET_DIGITAL_TIMER:
-    return "set digital timer";
-  case CEC_OPCODE_SET_EXTERNAL_TIMER:
-    return "set external timer";
-  case CEC_OPCODE_SET_TIMER_PROGRAM_TITLE:
-    return "set timer program title";
-  case CEC_OPCODE_TIMER_CLEARED_STATUS:
-    return "timer cleared status";
-  case CEC_OPCODE_TIMER_STATUS:
-    return "timer status";
-  case CEC_OPCODE_CEC_VERSION:
-    return "cec version";
-  case CEC_OPCODE_GET_CEC_VERSION:
-    return "get cec version";
-  case CEC_OPCODE_GIVE_PHYSICAL_ADDRESS:
-    return "give physical address";
-  case CEC_OPCODE_GET_MENU_LANGUAGE:
-    return "get menu language";
-  case CEC_OPCODE_REPORT_PHYSICAL_ADDRESS:
-    return "report physical address";
-  case CEC_OPCODE_SET_MENU_LANGUAGE:
-    return "set menu language";
-  case CEC_OPCODE_DECK_CONTROL:
-    return "deck control";
-  case CEC_OPCODE_DECK_STATUS:
-    return "deck status";
-  case CEC_OPCODE_GIVE_DECK_STATUS:
-    return "give deck status";
-  case CEC_OPCODE_PLAY:
-    return "play";
-  case CEC_OPCODE_GIVE_TUNER_DEVICE_STATUS:
-    return "give tuner status";
-  case CEC_OPCODE_SELECT_ANALOGUE_SERVICE:
-    return "select analogue service";
-  case CEC_OPCODE_SELECT_DIGITAL_SERVICE:
-    return "set digital service";
-  case CEC_OPCODE_TUNER_DEVICE_STATUS:
-    return "tuner device status";
-  case CEC_OPCODE_TUNER_STEP_DECREMENT:
-    return "tuner step decrement";
-  case CEC_OPCODE_TUNER_STEP_INCREMENT:
-    return "tuner step increment";
-  case CEC_OPCODE_DEVICE_VENDOR_ID:
-    return "device vendor id";
-  case CEC_OPCODE_GIVE_DEVICE_VENDOR_ID:
-    return "give device vendor id";
-  case CEC_OPCODE_VENDOR_COMMAND:
-    return "vendor command";
-  case CEC_OPCODE_VENDOR_COMMAND_WITH_ID:
-    return "vendor command with id";
-  case CEC_OPCODE_VENDOR_REMOTE_BUTTON_DOWN:
-    return "vendor remote button down";
-  case CEC_OPCODE_VENDOR_REMOTE_BUTTON_UP:
-    return "vendor remote button up";
-  case CEC_OPCODE_SET_OSD_STRING:
-    return "set osd string";
-  case CEC_OPCODE_GIVE_OSD_NAME:
-    return "give osd name";
-  case CEC_OPCODE_SET_OSD_NAME:
-    return "set osd name";
-  case CEC_OPCODE_MENU_REQUEST:
-    return "menu request";
-  case CEC_OPCODE_MENU_STATUS:
-    return "menu status";
-  case CEC_OPCODE_USER_CONTROL_PRESSED:
-    return "user control pressed";
-  case CEC_OPCODE_USER_CONTROL_RELEASE:
-    return "user control release";
-  case CEC_OPCODE_GIVE_DEVICE_POWER_STATUS:
-    return "give device power status";
-  case CEC_OPCODE_REPORT_POWER_STATUS:
-    return "report power status";
-  case CEC_OPCODE_FEATURE_ABORT:
-    return "feature abort";
-  case CEC_OPCODE_ABORT:
-    return "abort";
-  case CEC_OPCODE_GIVE_AUDIO_STATUS:
-    return "give audio status";
-  case CEC_OPCODE_GIVE_SYSTEM_AUDIO_MODE_STATUS:
-    return "give audio mode status";
-  case CEC_OPCODE_REPORT_AUDIO_STATUS:
-    return "report audio status";
-  case CEC_OPCODE_SET_SYSTEM_AUDIO_MODE:
-    return "set system audio mode";
-  case CEC_OPCODE_SYSTEM_AUDIO_MODE_REQUEST:
-    return "system audio mode request";
-  case CEC_OPCODE_SYSTEM_AUDIO_MODE_STATUS:
-    return "system audio mode status";
-  case CEC_OPCODE_SET_AUDIO_RATE:
-    return "set audio rate";
-  default:
-    return "UNKNOWN";
-  }
+  return CCECOpcodeInfo::ToString(opcode);
 }
 
 const char *CCECCommandHandler::ToString(const cec_system_audio_status mode)
@@ -37,15 +37,52 @@
 namespace CEC
 {
   class CCECBusDevice;
+  class CCECCommandHandler;
+  class CCECProcessor;
 
+  typedef bool (CCECCommandHandler::*cec_opcode_handler)(const cec_command &command);
+
+  /*!
+   * @brief Maps every opcode to the methods that handle it. Every command handler class has one table, that is
+   *        built when the library is loaded, so dispatching a command is a single lookup.
+   */
+  class CCECOpcodeTable
+  {
+  public:
+    CCECOpcodeTable(void (*registerHandlers)(CCECOpcodeTable &table));
+
+    /*!
+     * @brief Set the method that handles an opcode.
+     */
+    void SetHandler(cec_opcode opcode, cec_opcode_handler handler) { m_handlers[(uint8_t)opcode] = handler; }
+
+    /*!
+     * @brief Set a vendor specific method for an opcode. It's only called for commands that are sent to us, and
+     *        when it returns false the command is passed to the normal handler.
+     */
+    void SetOverride(cec_opcode opcode, cec_opcode_handler handler) { m_overrides[(uint8_t)opcode] = handler; }
+
+    cec_opcode_handler GetHandler(cec_opcode opcode) const { return m_handlers[(uint8_t)opcode]; }
+    cec_opcode_handler GetOverride(cec_opcode opcode) const { return m_overrides[(uint8_t)opcode]; }
+
+  private:
+    cec_opcode_handler m_handlers[256];
+    cec_opcode_handler m_overrides[256];
+  };
+
+  /*!
+   * @brief Handles the commands that are sent by devices of a vendor. It doesn't keep any state of its own: the
+   *        devices are looked up from the command, so all devices of a vendor share one instance.
+   */
   class CCECCommandHandler
   {
   public:
-    CCECCommandHandler(CCECBusDevice *busDevice);
+    CCECCommandHandler(CCECProcessor *processor);
     virtual ~CCECCommandHandler(void) {};
 
     virtual bool HandleCommand(const cec_command &command);
     virtual cec_vendor_id GetVendorId(void) { return CEC_VENDOR_UNKNOWN; };
+    virtual CCECOpcodeTable &GetOpcodeTable(void) { return m_opcodeTable; }
 
     static const char *ToString(const cec_menu_state state);
     static const char *ToString(const cec_deck_control_mode mode);
@@ -59,6 +96,8 @@ namespace CEC
     static const char *ToString(const cec_vendor_id vendor);
 
   protected:
+    static void RegisterHandlers(CCECOpcodeTable &table);
+
     virtual bool HandleActiveSource(const cec_command &command);
     virtual bool HandleDeckControl(const cec_command &command);
     virtual bool HandleDeviceCecVersion(const cec_command &command);
@@ -99,6 +138,9 @@ namespace CEC
     virtual void SetVendorId(const cec_command &command);
     virtual void SetPhysicalAddress(cec_logical_address iAddress, uint16_t iNewAddress);
 
-    CCECBusDevice *m_busDevice;
+    CCECProcessor *m_processor;
+
+  private:
+    static CCECOpcodeTable m_opcodeTable;
   };
 };
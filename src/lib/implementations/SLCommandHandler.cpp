@@ -36,9 +36,17 @@
 
 using namespace CEC;
 
-CSLCommandHandler::CSLCommandHandler(CCECBusDevice *busDevice) :
-    CCECCommandHandler(busDevice)
+CCECOpcodeTable CSLCommandHandler::m_opcodeTable(CSLCommandHandler::RegisterHandlers);
+
+CSLCommandHandler::CSLCommandHandler(CCECProcessor *processor) :
+    CCECCommandHandler(processor)
+{
+}
+
+void CSLCommandHandler::RegisterHandlers(CCECOpcodeTable &table)
 {
+  CCECCommandHandler::RegisterHandlers(table);
+  table.SetOverride(CEC_OPCODE_VENDOR_COMMAND, static_cast<cec_opcode_handler>(&CSLCommandHandler::HandleVendorCommand));
 }
 
 bool CSLCommandHandler::HandleVendorCommand(const cec_command &command)
@@ -52,7 +60,9 @@ bool CSLCommandHandler::HandleVendorCommand(const cec_command &command)
     response.PushBack(0x02);
     response.PushBack(0x05);
 
-    return m_busDevice->GetProcessor()->Transmit(response);
+    /* the reply is queued while a command is handled, so the command is handled once it was queued. a reply that
+       isn't acked is logged by the processor */
+    return m_processor->Transmit(response);
   }
 
   return false;
@@ -67,24 +77,3 @@ bool CSLCommandHandler::HandleGiveDeviceVendorId(const cec_command &command)
 
   return CCECCommandHandler::HandleGiveDeviceVendorId(command);
 }
-
-bool CSLCommandHandler::HandleCommand(const cec_command &command)
-{
-  bool bHandled(false);
-  if (m_busDevice->MyLogicalAddressContains(command.destination))
-  {
-    switch(command.opcode)
-    {
-    case CEC_OPCODE_VENDOR_COMMAND:
-      bHandled = HandleVendorCommand(command);
-      break;
-    default:
-      break;
-    }
-  }
-
-  if (!bHandled)
-    bHandled = CCECCommandHandler::HandleCommand(command);
-
-  return bHandled;
-}
@@ -38,14 +38,18 @@ namespace CEC
   class CSLCommandHandler : public CCECCommandHandler
   {
   public:
-    CSLCommandHandler(CCECBusDevice *busDevice);
+    CSLCommandHandler(CCECProcessor *processor);
     virtual ~CSLCommandHandler(void) {};
     virtual cec_vendor_id GetVendorId(void) { return CEC_VENDOR_LG; };
-
-    virtual bool HandleCommand(const cec_command &command);
+    virtual CCECOpcodeTable &GetOpcodeTable(void) { return m_opcodeTable; }
 
   protected:
+    static void RegisterHandlers(CCECOpcodeTable &table);
+
     virtual bool HandleGiveDeviceVendorId(const cec_command &command);
     virtual bool HandleVendorCommand(const cec_command &command);
+
+  private:
+    static CCECOpcodeTable m_opcodeTable;
   };
 };
@@ -36,7 +36,7 @@
 
 using namespace CEC;
 
-CVLCommandHandler::CVLCommandHandler(CCECBusDevice *busDevice) :
-    CCECCommandHandler(busDevice)
+CVLCommandHandler::CVLCommandHandler(CCECProcessor *processor) :
+    CCECCommandHandler(processor)
 {
 }
@@ -0,0 +1,77 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "os-dependent.h"
+#include <stdint.h>
+
+namespace CEC
+{
+  /*!
+   * @brief Full memory barrier. Used by the lock-free buffers to publish an entry
+   *        before the index that makes it visible to the other thread.
+   */
+  inline void AtomicBarrier(void)
+  {
+#if defined(__WINDOWS__)
+    MemoryBarrier();
+#else
+    __sync_synchronize();
+#endif
+  }
+
+  /*!
+   * @brief Replace the value with iNew when it's still iOld.
+   * @return True when the value was replaced, false when another thread changed it first.
+   */
+  inline bool AtomicCompareAndSwap(volatile uint32_t *iValue, uint32_t iOld, uint32_t iNew)
+  {
+#if defined(__WINDOWS__)
+    return (uint32_t)InterlockedCompareExchange((volatile LONG *)iValue, (LONG)iNew, (LONG)iOld) == iOld;
+#else
+    return __sync_bool_compare_and_swap(iValue, iOld, iNew);
+#endif
+  }
+
+  /*!
+   * @brief Increase the value by one.
+   * @return The new value.
+   */
+  inline uint32_t AtomicIncrement(volatile uint32_t *iValue)
+  {
+#if defined(__WINDOWS__)
+    return (uint32_t)InterlockedIncrement((volatile LONG *)iValue);
+#else
+    return __sync_add_and_fetch(iValue, 1);
+#endif
+  }
+};
@@ -0,0 +1,66 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "os-dependent.h"
+
+namespace CEC
+{
+  /*!
+   * @brief A file descriptor that is readable while it is signalled, for clients that wait for libcec in their own
+   *        poll() or select() loop. An eventfd is used on Linux and a pipe on other posix systems. It isn't
+   *        supported on Windows. Signal() and Reset() only make a system call when the state changes, and the
+   *        caller has to make sure they're not called concurrently.
+   */
+  class CEventFd
+  {
+  public:
+    CEventFd(void);
+    virtual ~CEventFd(void);
+
+    bool Open(void);
+    bool IsOpen(void) const { return m_fd[0] != -1; }
+    void Close(void);
+
+    /*!
+     * @return The descriptor to wait for, or -1 when it isn't open.
+     */
+    int  GetFd(void) const { return m_fd[0]; }
+
+    void Signal(void);
+    void Reset(void);
+
+  private:
+    int  m_fd[2];
+    bool m_bSignalled;
+  };
+};
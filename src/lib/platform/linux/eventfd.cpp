@@ -0,0 +1,121 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "../eventfd.h"
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#endif
+
+using namespace CEC;
+
+CEventFd::CEventFd(void) :
+    m_bSignalled(false)
+{
+  m_fd[0] = -1;
+  m_fd[1] = -1;
+}
+
+CEventFd::~CEventFd(void)
+{
+  Close();
+}
+
+bool CEventFd::Open(void)
+{
+  if (IsOpen())
+    return true;
+
+  m_bSignalled = false;
+#if defined(__linux__)
+  /* an eventfd is readable and writable through the same descriptor */
+  m_fd[0] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  m_fd[1] = m_fd[0];
+  return m_fd[0] != -1;
+#else
+  if (pipe(m_fd) != 0)
+  {
+    m_fd[0] = -1;
+    m_fd[1] = -1;
+    return false;
+  }
+  fcntl(m_fd[0], F_SETFL, O_NONBLOCK);
+  fcntl(m_fd[1], F_SETFL, O_NONBLOCK);
+  fcntl(m_fd[0], F_SETFD, FD_CLOEXEC);
+  fcntl(m_fd[1], F_SETFD, FD_CLOEXEC);
+  return true;
+#endif
+}
+
+void CEventFd::Close(void)
+{
+  if (m_fd[1] != -1 && m_fd[1] != m_fd[0])
+    close(m_fd[1]);
+  if (m_fd[0] != -1)
+    close(m_fd[0]);
+  m_fd[0] = -1;
+  m_fd[1] = -1;
+  m_bSignalled = false;
+}
+
+void CEventFd::Signal(void)
+{
+  if (m_fd[1] == -1 || m_bSignalled)
+    return;
+
+#if defined(__linux__)
+  uint64_t iValue(1);
+  m_bSignalled = write(m_fd[1], &iValue, sizeof(iValue)) == sizeof(iValue);
+#else
+  uint8_t iValue(1);
+  m_bSignalled = write(m_fd[1], &iValue, sizeof(iValue)) == sizeof(iValue);
+#endif
+}
+
+void CEventFd::Reset(void)
+{
+  if (m_fd[0] == -1 || !m_bSignalled)
+    return;
+
+#if defined(__linux__)
+  uint64_t iValue;
+  if (read(m_fd[0], &iValue, sizeof(iValue)) == sizeof(iValue))
+    m_bSignalled = false;
+#else
+  uint8_t iValue;
+  while (read(m_fd[0], &iValue, sizeof(iValue)) > 0) {}
+  m_bSignalled = false;
+#endif
+}
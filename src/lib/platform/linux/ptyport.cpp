@@ -0,0 +1,128 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../ptyport.h"
+
+using namespace std;
+using namespace CEC;
+
+CPtyTransport::CPtyTransport(void) :
+    m_slaveFd(-1)
+{
+}
+
+CPtyTransport::~CPtyTransport(void)
+{
+  Close();
+}
+
+bool CPtyTransport::Open(const std::string &strName, uint32_t iBaudrate)
+{
+  (void) strName;
+  (void) iBaudrate;
+
+  CLockObject lock(&m_mutex);
+  if (m_fd != -1)
+  {
+    m_error = "already open";
+    return false;
+  }
+
+  if (!CreateWakeupPipe())
+    return false;
+
+  m_fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (m_fd == -1 || grantpt(m_fd) != 0 || unlockpt(m_fd) != 0)
+  {
+    m_error = strerror(errno);
+    lock.Leave();
+    Close();
+    return false;
+  }
+
+  const char *strSlave = ptsname(m_fd);
+  if (!strSlave)
+  {
+    m_error = strerror(errno);
+    lock.Leave();
+    Close();
+    return false;
+  }
+  m_strSlaveName = strSlave;
+  m_name         = m_strSlaveName;
+
+  /* keep the slave side open ourselves, or the master reports a hangup every
+     time the client closes and reopens it */
+  m_slaveFd = open(strSlave, O_RDWR | O_NOCTTY);
+  if (m_slaveFd == -1 || tcgetattr(m_slaveFd, &m_options) != 0)
+  {
+    m_error = strerror(errno);
+    lock.Leave();
+    Close();
+    return false;
+  }
+
+  cfmakeraw(&m_options);
+  if (tcsetattr(m_slaveFd, TCSANOW, &m_options) != 0)
+  {
+    m_error = strerror(errno);
+    lock.Leave();
+    Close();
+    return false;
+  }
+
+  fcntl(m_fd, F_SETFL, O_NONBLOCK);
+  return true;
+}
+
+void CPtyTransport::Close(void)
+{
+  CSerialPort::Close();
+
+  CLockObject lock(&m_mutex);
+  if (m_slaveFd != -1)
+  {
+    close(m_slaveFd);
+    m_slaveFd = -1;
+  }
+  m_strSlaveName = "";
+}
+
+std::string CPtyTransport::GetSlaveName(void)
+{
+  CLockObject lock(&m_mutex);
+  return m_strSlaveName;
+}
@@ -32,6 +32,8 @@
 
 #include <stdio.h>
 #include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
 #include "../serialport.h"
 #include "../baudrate.h"
 #include "../timeutils.h"
@@ -53,6 +55,8 @@ using namespace CEC;
 CSerialPort::CSerialPort()
 {
   m_fd = -1;
+  m_wakeupPipe[0] = -1;
+  m_wakeupPipe[1] = -1;
 }
 
 CSerialPort::~CSerialPort()
@@ -60,7 +64,7 @@ CSerialPort::~CSerialPort()
   Close();
 }
 
-int8_t CSerialPort::Write(CCECAdapterMessage *data)
+int32_t CSerialPort::Write(const uint8_t *data, uint32_t len)
 {
   fd_set port;
 
@@ -73,7 +77,7 @@ int8_t CSerialPort::Write(CCECAdapterMessage *data)
 
   int32_t byteswritten = 0;
 
-  while (byteswritten < (int32_t) data->size())
+  while (byteswritten < (int32_t) len)
   {
     FD_ZERO(&port);
     FD_SET(m_fd, &port);
@@ -84,7 +88,7 @@ int8_t CSerialPort::Write(CCECAdapterMessage *data)
       return -1;
     }
 
-    returnv = write(m_fd, data->packet.data + byteswritten, data->size() - byteswritten);
+    returnv = write(m_fd, data + byteswritten, len - byteswritten);
     if (returnv == -1)
     {
       m_error = strerror(errno);
@@ -106,13 +110,8 @@ int8_t CSerialPort::Write(CCECAdapterMessage *data)
   return byteswritten;
 }
 
-int32_t CSerialPort::Read(uint8_t* data, uint32_t len, uint64_t iTimeoutMs /*= 0*/)
+int32_t CSerialPort::Read(uint8_t* data, uint32_t len)
 {
-  fd_set port;
-  struct timeval timeout, *tv;
-  int64_t now(0), target(0);
-  int32_t bytesread = 0;
-
   CLockObject lock(&m_mutex);
   if (m_fd == -1)
   {
@@ -120,50 +119,13 @@ int32_t CSerialPort::Read(uint8_t* data, uint32_t len, uint64_t iTimeoutMs /*= 0
     return -1;
   }
 
-  if (iTimeoutMs > 0)
-  {
-    now    = GetTimeMs();
-    target = now + (int64_t) iTimeoutMs;
-  }
-
-  while (bytesread < (int32_t) len && (iTimeoutMs == 0 || target > now))
+  int32_t bytesread = read(m_fd, data, len);
+  if (bytesread == -1)
   {
-    if (iTimeoutMs == 0)
-    {
-      tv = NULL;
-    }
-    else
-    {
-      timeout.tv_sec  = ((long int)target - (long int)now) / (long int)1000.;
-      timeout.tv_usec = ((long int)target - (long int)now) % (long int)1000.;
-      tv = &timeout;
-    }
-
-    FD_ZERO(&port);
-    FD_SET(m_fd, &port);
-    int32_t returnv = select(m_fd + 1, &port, NULL, NULL, tv);
-
-    if (returnv == -1)
-    {
-      m_error = strerror(errno);
-      return -1;
-    }
-    else if (returnv == 0)
-    {
-      break; //nothing to read
-    }
-
-    returnv = read(m_fd, data + bytesread, len - bytesread);
-    if (returnv == -1)
-    {
-      m_error = strerror(errno);
-      return -1;
-    }
-
-    bytesread += returnv;
-
-    if (iTimeoutMs > 0)
-      now = GetTimeMs();
+    if (errno == EAGAIN || errno == EINTR)
+      return 0;
+    m_error = strerror(errno);
+    return -1;
   }
 
   //print what's read to stdout for debugging
@@ -179,8 +141,79 @@ int32_t CSerialPort::Read(uint8_t* data, uint32_t len, uint64_t iTimeoutMs /*= 0
   return bytesread;
 }
 
+bool CSerialPort::Wait(uint64_t iTimeoutMs /* = 0 */)
+{
+  struct pollfd fds[2];
+
+  CLockObject lock(&m_mutex);
+  if (m_fd == -1)
+  {
+    m_error = "port closed";
+    return false;
+  }
+
+  /* wait for data on the port or for a call to Interrupt(), whichever comes first */
+  fds[0].fd      = m_fd;
+  fds[0].events  = POLLIN;
+  fds[0].revents = 0;
+  fds[1].fd      = m_wakeupPipe[0];
+  fds[1].events  = POLLIN;
+  fds[1].revents = 0;
+
+  /* don't keep the port locked while waiting, or IsOpen() would block until data arrives */
+  lock.Leave();
+  int timeout = iTimeoutMs == 0 ? -1 : (iTimeoutMs > INT_MAX ? INT_MAX : (int) iTimeoutMs);
+  int returnv = poll(fds, 2, timeout);
+  lock.Lock();
+
+  if (returnv == -1)
+  {
+    if (errno != EINTR)
+      m_error = strerror(errno);
+    return false;
+  }
+
+  if (fds[1].revents & POLLIN)
+  {
+    uint8_t buff[32];
+    while (read(m_wakeupPipe[0], buff, sizeof(buff)) > 0) {}
+  }
+
+  /* errors are reported by the next call to Read() */
+  return m_fd != -1 && (fds[0].revents & (POLLIN | POLLERR | POLLHUP)) != 0;
+}
+
+void CSerialPort::Interrupt(void)
+{
+  /* Wait() doesn't hold the lock while polling. holding it here keeps Close() from closing the pipe, and another
+     descriptor from reusing its number, between the check and the write */
+  CLockObject lock(&m_mutex);
+  if (m_wakeupPipe[1] != -1)
+  {
+    uint8_t buff(0);
+    if (write(m_wakeupPipe[1], &buff, 1) == -1 && errno != EAGAIN)
+      m_error = strerror(errno);
+  }
+}
+
+bool CSerialPort::CreateWakeupPipe(void)
+{
+  if (m_wakeupPipe[0] == -1)
+  {
+    if (pipe(m_wakeupPipe) != 0)
+    {
+      m_error = strerror(errno);
+      return false;
+    }
+    fcntl(m_wakeupPipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(m_wakeupPipe[1], F_SETFL, O_NONBLOCK);
+  }
+
+  return true;
+}
+
 //setting all this stuff up is a pain in the ass
-bool CSerialPort::Open(string name, uint32_t baudrate, uint8_t databits /* = 8 */, uint8_t stopbits /* = 1 */, uint8_t parity /* = PAR_NONE */)
+bool CSerialPort::Open(string name, uint32_t baudrate, uint8_t databits, uint8_t stopbits /* = 1 */, uint8_t parity /* = PAR_NONE */)
 {
   m_name = name;
   m_error = strerror(errno);
@@ -204,6 +237,9 @@ bool CSerialPort::Open(string name, uint32_t baudrate, uint8_t databits /* = 8 *
     return false;
   }
 
+  if (!CreateWakeupPipe())
+    return false;
+
   m_fd = open(name.c_str(), O_RDWR | O_NOCTTY | O_NDELAY);
 
   if (m_fd == -1)
@@ -280,6 +316,14 @@ void CSerialPort::Close()
     m_name = "";
     m_error = "";
   }
+
+  if (m_wakeupPipe[0] != -1)
+  {
+    close(m_wakeupPipe[0]);
+    close(m_wakeupPipe[1]);
+    m_wakeupPipe[0] = -1;
+    m_wakeupPipe[1] = -1;
+  }
 }
 
 bool CSerialPort::SetBaudRate(uint32_t baudrate)
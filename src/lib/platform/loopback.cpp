@@ -0,0 +1,213 @@
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "loopback.h"
+#include "timeutils.h"
+
+using namespace std;
+using namespace CEC;
+
+CLoopbackTransport::CLoopbackTransport(uint32_t iBufferSize /* = 4096 */) :
+    m_peer(NULL),
+    m_buffer(iBufferSize),
+    m_bOpen(false),
+    m_bInterrupted(false),
+    m_bWriterWaiting(false)
+{
+}
+
+CLoopbackTransport::~CLoopbackTransport(void)
+{
+  Close();
+  Connect(NULL);
+}
+
+/* serialises the wiring of all loopbacks, so a pair is always connected or disconnected as a whole */
+static CMutex g_connectMutex;
+
+void CLoopbackTransport::Connect(CLoopbackTransport *peer)
+{
+  CLockObject connectLock(&g_connectMutex);
+  if (m_peer && m_peer != peer)
+    Pair(this, m_peer, false);
+
+  if (peer && peer != this && peer->m_peer != this)
+  {
+    if (peer->m_peer)
+      Pair(peer, peer->m_peer, false);
+    Pair(this, peer, true);
+  }
+}
+
+void CLoopbackTransport::Pair(CLoopbackTransport *first, CLoopbackTransport *second, bool bConnect)
+{
+  /* the end with the lowest address is always locked first */
+  if (second < first)
+  {
+    CLoopbackTransport *tmp = first;
+    first  = second;
+    second = tmp;
+  }
+
+  CLockObject firstLock(&first->m_mutex);
+  CLockObject secondLock(&second->m_mutex);
+  first->m_peer  = bConnect ? second : NULL;
+  second->m_peer = bConnect ? first : NULL;
+
+  /* writers that are waiting for space give up when their peer goes away */
+  first->m_condition.Broadcast();
+  second->m_condition.Broadcast();
+}
+
+bool CLoopbackTransport::Open(const std::string &strName, uint32_t iBaudrate)
+{
+  (void) iBaudrate;
+  CLockObject lock(&m_mutex);
+  if (!m_peer)
+  {
+    m_strError = "loopback is not connected";
+    return false;
+  }
+
+  m_strName      = strName;
+  m_bOpen        = true;
+  m_bInterrupted = false;
+  m_buffer.Clear();
+  return true;
+}
+
+bool CLoopbackTransport::IsOpen(void)
+{
+  CLockObject lock(&m_mutex);
+  return m_bOpen;
+}
+
+void CLoopbackTransport::Close(void)
+{
+  CLockObject lock(&m_mutex);
+  m_bOpen = false;
+  m_condition.Broadcast();
+}
+
+int32_t CLoopbackTransport::Write(const uint8_t *data, uint32_t iLength)
+{
+  CLockObject lock(&m_mutex);
+  if (!m_bOpen || !m_peer)
+  {
+    m_strError = "port closed";
+    return -1;
+  }
+
+  CLoopbackTransport *peer = m_peer;
+  lock.Leave();
+
+  if (peer->Receive(data, iLength) < iLength)
+  {
+    lock.Lock();
+    m_strError = "the other end was closed";
+    return -1;
+  }
+
+  return (int32_t) iLength;
+}
+
+uint32_t CLoopbackTransport::Receive(const uint8_t *data, uint32_t iLength)
+{
+  /* the ring buffer takes one producer, and more than one thread can write to the
+     other end. writes are not interleaved, even when they have to wait for space */
+  CLockObject writeLock(&m_writeMutex);
+  CLockObject lock(&m_mutex);
+  uint32_t iWritten(0);
+  while (true)
+  {
+    uint32_t iPushed = m_buffer.Push(data + iWritten, iLength - iWritten);
+    if (iPushed > 0)
+      m_condition.Broadcast();
+
+    iWritten += iPushed;
+    if (iWritten == iLength || !m_bOpen || !m_peer)
+      break;
+
+    /* the buffer is full. wait until Read() makes room */
+    m_bWriterWaiting = true;
+    m_condition.Wait(&m_mutex);
+  }
+
+  return iWritten;
+}
+
+int32_t CLoopbackTransport::Read(uint8_t *data, uint32_t iLength)
+{
+  if (!IsOpen())
+  {
+    m_strError = "port closed";
+    return -1;
+  }
+
+  uint32_t iRead = m_buffer.Pop(data, iLength);
+  if (iRead > 0)
+  {
+    CLockObject lock(&m_mutex);
+    if (m_bWriterWaiting)
+    {
+      m_bWriterWaiting = false;
+      m_condition.Broadcast();
+    }
+  }
+
+  return (int32_t) iRead;
+}
+
+bool CLoopbackTransport::Wait(uint64_t iTimeoutMs /* = 0 */)
+{
+  CLockObject lock(&m_mutex);
+  int64_t iNow    = GetTimeMs();
+  int64_t iTarget = iNow + (int64_t) iTimeoutMs;
+
+  while (m_bOpen && !m_bInterrupted && m_buffer.IsEmpty())
+  {
+    if (iTimeoutMs > 0 && iNow >= iTarget)
+      break;
+    m_condition.Wait(&m_mutex, iTimeoutMs > 0 ? (uint32_t) (iTarget - iNow) : 0);
+    iNow = GetTimeMs();
+  }
+
+  m_bInterrupted = false;
+  return m_bOpen && !m_buffer.IsEmpty();
+}
+
+void CLoopbackTransport::Interrupt(void)
+{
+  CLockObject lock(&m_mutex);
+  m_bInterrupted = true;
+  m_condition.Broadcast();
+}
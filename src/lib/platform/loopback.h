@@ -0,0 +1,84 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "transport.h"
+#include "threads.h"
+#include "../util/ringbuffer.h"
+
+namespace CEC
+{
+  /*!
+   * @brief In-memory transport. Everything that is written to one end can be read
+   *        from the other end, without any serial port or timing in between.
+   */
+  class CLoopbackTransport : public ITransport
+  {
+  public:
+    CLoopbackTransport(uint32_t iBufferSize = 4096);
+    virtual ~CLoopbackTransport(void);
+
+    /*!
+     * @brief Connect two ends of a loopback. Has to be called before Open().
+     *        Both ends are disconnected from the ends they were connected to.
+     * @param peer The other end, or NULL to disconnect.
+     */
+    void Connect(CLoopbackTransport *peer);
+
+    bool Open(const std::string &strName, uint32_t iBaudrate);
+    bool IsOpen(void);
+    void Close(void);
+
+    int32_t Write(const uint8_t *data, uint32_t iLength);
+    int32_t Read(uint8_t *data, uint32_t iLength);
+    bool Wait(uint64_t iTimeoutMs = 0);
+    void Interrupt(void);
+
+    std::string GetError(void) { return m_strError; }
+    std::string GetName(void)  { return m_strName; }
+
+  private:
+    static void Pair(CLoopbackTransport *first, CLoopbackTransport *second, bool bConnect);
+    uint32_t Receive(const uint8_t *data, uint32_t iLength);
+
+    CLoopbackTransport *   m_peer;
+    CecRingBuffer<uint8_t> m_buffer;
+    bool                   m_bOpen;
+    bool                   m_bInterrupted;
+    bool                   m_bWriterWaiting;
+    std::string            m_strName;
+    std::string            m_strError;
+    CMutex                 m_mutex;
+    CMutex                 m_writeMutex;
+    CCondition             m_condition;
+  };
+};
@@ -0,0 +1,68 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "serialport.h"
+
+namespace CEC
+{
+  /*!
+   * @brief The master side of a pseudo terminal. Anything that opens the slave
+   *        side (see GetSlaveName()) as a serial port talks to this transport,
+   *        so an emulated adapter can be used with an unmodified libCEC.
+   *        Only available on posix systems.
+   */
+  class CPtyTransport : public CSerialPort
+  {
+  public:
+    CPtyTransport(void);
+    virtual ~CPtyTransport(void);
+
+    /*!
+     * @brief Create a new pseudo terminal.
+     * @param strName Ignored, the name of the slave is picked by the system.
+     * @param iBaudrate Ignored.
+     * @return True when created, false otherwise.
+     */
+    bool Open(const std::string &strName, uint32_t iBaudrate);
+    void Close(void);
+
+    /*!
+     * @return The path of the slave side, or an empty string when not open.
+     */
+    std::string GetSlaveName(void);
+
+  private:
+    int         m_slaveFd;
+    std::string m_strSlaveName;
+  };
+};
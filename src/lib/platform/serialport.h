@@ -35,7 +35,7 @@
 #include <cectypes.h>
 #include <string>
 #include <stdint.h>
-#include "../AdapterCommunication.h"
+#include "transport.h"
 #include "../platform/threads.h"
 
 #ifndef __WINDOWS__
@@ -50,23 +50,26 @@ namespace CEC
   #define PAR_EVEN 1
   #define PAR_ODD  2
 
-  class CSerialPort
+  class CSerialPort : public ITransport
   {
     public:
       CSerialPort();
       virtual ~CSerialPort();
 
-      bool Open(std::string name, uint32_t baudrate, uint8_t databits = 8, uint8_t stopbits = 1, uint8_t parity = PAR_NONE);
+      bool Open(const std::string &name, uint32_t baudrate) { return Open(name, baudrate, 8); }
+      bool Open(std::string name, uint32_t baudrate, uint8_t databits, uint8_t stopbits = 1, uint8_t parity = PAR_NONE);
       bool IsOpen();
       void Close();
 
-      int8_t Write(CCECAdapterMessage *data);
-      int32_t Read(uint8_t* data, uint32_t len, uint64_t iTimeoutMs = 0);
+      int32_t Write(const uint8_t *data, uint32_t len);
+      int32_t Read(uint8_t* data, uint32_t len);
+      bool Wait(uint64_t iTimeoutMs = 0);
+      void Interrupt(void);
 
       std::string GetError() { return m_error; }
       std::string GetName() { return m_name; }
 
-  private:
+  protected:
       bool SetBaudRate(uint32_t baudrate);
 
       std::string     m_error;
@@ -85,9 +88,13 @@ namespace CEC
       int64_t            m_iTimeout;
       CecBuffer<uint8_t> m_buffer;
       HANDLE             m_ovHandle;
+      HANDLE             m_wakeupEvent;
   #else
+      bool CreateWakeupPipe(void);
+
       struct termios     m_options;
       int                m_fd;
+      int                m_wakeupPipe[2];
   #endif
   };
 };
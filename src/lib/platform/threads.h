@@ -91,6 +91,7 @@ namespace CEC
     virtual bool CreateThread(bool bWait = true);
     virtual bool StopThread(bool bWaitForExit = true);
     virtual bool IsStopped(void) const { return m_bStop; };
+    virtual bool IsCurrentThread(void) const { return m_bRunning && pthread_equal(pthread_self(), m_thread) != 0; }
     virtual bool Sleep(uint32_t iTimeout);
 
     static void *ThreadHandler(CThread *thread);
@@ -0,0 +1,105 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include <string>
+#include <stdint.h>
+
+namespace CEC
+{
+  /*!
+   * @brief A byte stream to the adapter. CAdapterCommunication only talks to the
+   *        adapter through this interface, so the serial port can be replaced by
+   *        a pseudo terminal or an in-memory loopback.
+   */
+  class ITransport
+  {
+  public:
+    virtual ~ITransport(void) {};
+
+    /*!
+     * @brief Open the connection.
+     * @param strName The name of the port to open.
+     * @param iBaudrate The baudrate to use. Ignored by transports that don't have one.
+     * @return True when opened, false otherwise.
+     */
+    virtual bool Open(const std::string &strName, uint32_t iBaudrate) = 0;
+
+    /*!
+     * @return True when the connection is open, false otherwise.
+     */
+    virtual bool IsOpen(void) = 0;
+
+    /*!
+     * @brief Close the connection.
+     */
+    virtual void Close(void) = 0;
+
+    /*!
+     * @brief Write data. Blocks until all data has been written.
+     * @param data The data to write.
+     * @param iLength The number of bytes to write.
+     * @return The number of bytes written or -1 on error.
+     */
+    virtual int32_t Write(const uint8_t *data, uint32_t iLength) = 0;
+
+    /*!
+     * @brief Read the data that is available. Does not block.
+     * @param data The buffer to read into.
+     * @param iLength The size of the buffer.
+     * @return The number of bytes read, 0 when nothing was available or -1 on error.
+     */
+    virtual int32_t Read(uint8_t *data, uint32_t iLength) = 0;
+
+    /*!
+     * @brief Wait until data can be read, Interrupt() is called or the timeout expires.
+     * @param iTimeoutMs The timeout in milliseconds. 0 waits until data arrives or Interrupt() is called.
+     * @return True when data can be read, false otherwise.
+     */
+    virtual bool Wait(uint64_t iTimeoutMs = 0) = 0;
+
+    /*!
+     * @brief Make a pending or the next call to Wait() return immediately. Can be called from any thread.
+     */
+    virtual void Interrupt(void) = 0;
+
+    /*!
+     * @return The last error.
+     */
+    virtual std::string GetError(void) = 0;
+
+    /*!
+     * @return The name of the port.
+     */
+    virtual std::string GetName(void) = 0;
+  };
+};
@@ -56,14 +56,16 @@ CSerialPort::CSerialPort(void) :
   m_iStopbits(0),
   m_iParity(0)
 {
+  m_wakeupEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
 }
 
 CSerialPort::~CSerialPort(void)
 {
   Close();
+  CloseHandle(m_wakeupEvent);
 }
 
-bool CSerialPort::Open(string name, uint32_t baudrate, uint8_t databits, uint8_t stopbits, uint8_t parity)
+bool CSerialPort::Open(string name, uint32_t baudrate, uint8_t databits, uint8_t stopbits /* = 1 */, uint8_t parity /* = PAR_NONE */)
 {
   CStdString strComPath = "\\\\.\\" + name;
   CLockObject lock(&m_mutex);
@@ -167,24 +169,24 @@ void CSerialPort::Close(void)
   }
 }
 
-int8_t CSerialPort::Write(CCECAdapterMessage *data)
+int32_t CSerialPort::Write(const uint8_t *data, uint32_t len)
 {
   CLockObject lock(&m_mutex);
   DWORD iBytesWritten = 0;
   if (!m_bIsOpen)
     return -1;
 
-  if (!WriteFile(m_handle, data->packet.data, data->size(), &iBytesWritten, NULL))
+  if (!WriteFile(m_handle, data, len, &iBytesWritten, NULL))
   {
     m_error = "Error while writing to COM port";
     FormatWindowsError(GetLastError(), m_error);
     return -1;
   }
 
-  return (int8_t)iBytesWritten;
+  return (int32_t)iBytesWritten;
 }
 
-int32_t CSerialPort::Read(uint8_t* data, uint32_t len, uint64_t iTimeoutMs /* = 0 */)
+int32_t CSerialPort::Read(uint8_t* data, uint32_t len)
 {
   CLockObject lock(&m_mutex);
   int32_t iReturn(-1);
@@ -209,6 +211,35 @@ int32_t CSerialPort::Read(uint8_t* data, uint32_t len, uint64_t iTimeoutMs /* =
   return iReturn;
 }
 
+bool CSerialPort::Wait(uint64_t iTimeoutMs /* = 0 */)
+{
+  /* the port is opened in non-blocking mode, so we check its input queue every 5ms
+     until data arrives, the timeout expires or Interrupt() is called */
+  int64_t iTarget = iTimeoutMs > 0 ? GetTimeMs() + (int64_t) iTimeoutMs : 0;
+  while (true)
+  {
+    CLockObject lock(&m_mutex);
+    if (!m_bIsOpen)
+      return false;
+
+    DWORD iErrors(0);
+    COMSTAT status;
+    if (!ClearCommError(m_handle, &iErrors, &status) || status.cbInQue > 0)
+      return true;
+
+    /* don't keep the port locked while waiting, or IsOpen() would block until data arrives */
+    lock.Leave();
+    if ((iTarget > 0 && GetTimeMs() >= iTarget) ||
+        WaitForSingleObject(m_wakeupEvent, 5) == WAIT_OBJECT_0)
+      return false;
+  }
+}
+
+void CSerialPort::Interrupt(void)
+{
+  SetEvent(m_wakeupEvent);
+}
+
 bool CSerialPort::SetBaudRate(uint32_t baudrate)
 {
   int32_t rate = IntToBaudrate(baudrate);
@@ -81,6 +81,28 @@ namespace CEC
         return bReturn;
       }
 
+      /*!
+       * @brief Pop up to iMax entries while holding the lock once.
+       * @return The number of entries that were copied to entries.
+       */
+      unsigned int Pop(_BType *entries, unsigned int iMax)
+      {
+        unsigned int iCount(0);
+        CLockObject lock(&m_mutex);
+        while (iCount < iMax && !m_buffer.empty())
+        {
+          entries[iCount++] = m_buffer.front();
+          m_buffer.pop();
+        }
+        return iCount;
+      }
+
+      bool IsEmpty(void)
+      {
+        CLockObject lock(&m_mutex);
+        return m_buffer.empty();
+      }
+
     private:
       unsigned int       m_maxSize;
       std::queue<_BType> m_buffer;
@@ -0,0 +1,52 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "StdString.h"
+
+/*!
+ * @brief Format a log message and pass it to the logger, but only when its level is enabled in the log level mask of
+ *        the client. A disabled message costs a single check and none of the arguments are formatted.
+ * @param logger The CLibCEC or CCECProcessor instance to log to.
+ * @param level The level of the message.
+ * @param ... The format string and its arguments.
+ */
+#define LIB_CEC_LOG(logger, level, ...) \
+  do \
+  { \
+    if ((logger)->IsLogLevelEnabled(level)) \
+    { \
+      CStdString strLibCecLog; \
+      strLibCecLog.Format(__VA_ARGS__); \
+      (logger)->AddLog(level, strLibCecLog); \
+    } \
+  } while (0)
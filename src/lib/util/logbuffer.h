@@ -0,0 +1,313 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include <cectypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "../platform/atomics.h"
+#include "../platform/threads.h"
+
+namespace CEC
+{
+  #define CEC_LOG_BUFFER_SIZE  8192
+  #define CEC_LOG_RECORD_ALIGN 16
+  #define CEC_LOG_MAX_LENGTH   1023 /* the size of cec_log_message::message, without the terminating 0 */
+
+  typedef enum cec_log_record_state
+  {
+    CEC_LOG_RECORD_FREE = 0,
+    CEC_LOG_RECORD_COMMITTED,
+    CEC_LOG_RECORD_PADDING
+  } cec_log_record_state;
+
+  typedef enum cec_log_source
+  {
+    CEC_LOG_SOURCE_TEXT = 0,   /*!< a formatted message */
+    CEC_LOG_SOURCE_TRAFFIC_IN, /*!< the bytes of a received frame, formatted when it's read */
+    CEC_LOG_SOURCE_TRAFFIC_OUT /*!< the bytes of a transmitted frame, formatted when it's read */
+  } cec_log_source;
+
+  typedef const char *(*cec_log_opcode_name)(const cec_opcode opcode);
+
+  /*!
+   * @brief The header of a record in the log buffer. The message and a terminating 0 directly follow it, and the
+   *        record is padded to a multiple of CEC_LOG_RECORD_ALIGN bytes.
+   */
+  typedef struct cec_log_record
+  {
+    int64_t          iTime;
+    uint16_t         iSize;   /*!< the size of the record, including this header and the padding */
+    uint16_t         iLength; /*!< the length of the message */
+    uint8_t          iLevel;
+    uint8_t          iSource;
+    volatile uint8_t iState;
+    uint8_t          iReserved;
+
+    const char *Message(void) const { return (const char *)(this + 1); }
+  } cec_log_record;
+
+  /*!
+   * @brief Log records of variable length in a preallocated buffer, so adding a message only copies its text.
+   *
+   * Any thread can Push() without taking a lock: space is reserved by moving the reserve index with a compare and
+   * swap, and the record is committed by setting its state once it's written. A record that doesn't fit at the end
+   * of the buffer is preceded by a padding record and starts at the beginning. When the buffer is full, the record
+   * is dropped and counted. The consumer frees the records that it read and clears their memory again, so a
+   * record whose state is still CEC_LOG_RECORD_FREE is being written.
+   */
+  class CecLogBuffer
+  {
+  public:
+    CecLogBuffer(uint32_t iMinSize = CEC_LOG_BUFFER_SIZE) :
+      m_iReserve(0),
+      m_iTail(0),
+      m_iDropped(0),
+      m_iReportedDropped(0),
+      m_iLastTime(0),
+      m_opcodeName(NULL)
+    {
+      m_iSize = CEC_LOG_RECORD_ALIGN * 2;
+      while (m_iSize < iMinSize)
+        m_iSize <<= 1;
+      m_iMask  = m_iSize - 1;
+      m_buffer = new uint64_t[m_iSize / sizeof(uint64_t)];
+      memset(m_buffer, 0, m_iSize);
+    }
+
+    virtual ~CecLogBuffer(void)
+    {
+      delete[] m_buffer;
+    }
+
+    /** @name Producers */
+    //@{
+    bool Push(cec_log_level level, int64_t iTime, const char *strMessage, size_t iLength, uint8_t iSource = CEC_LOG_SOURCE_TEXT)
+    {
+      if (iLength > CEC_LOG_MAX_LENGTH)
+        iLength = CEC_LOG_MAX_LENGTH;
+
+      uint32_t iRecordSize = (uint32_t) (sizeof(cec_log_record) + iLength + 1 + CEC_LOG_RECORD_ALIGN - 1) & ~(CEC_LOG_RECORD_ALIGN - 1);
+      uint32_t iHead, iOffset, iPadding;
+      do
+      {
+        iHead    = m_iReserve;
+        iOffset  = iHead & m_iMask;
+        iPadding = iOffset + iRecordSize > m_iSize ? m_iSize - iOffset : 0;
+        if ((iHead - m_iTail) + iPadding + iRecordSize > m_iSize)
+        {
+          AtomicIncrement(&m_iDropped);
+          return false;
+        }
+      } while (!AtomicCompareAndSwap(&m_iReserve, iHead, iHead + iPadding + iRecordSize));
+
+      if (iPadding > 0)
+      {
+        cec_log_record *padding = At(iOffset);
+        padding->iSize = (uint16_t) iPadding;
+        AtomicBarrier();
+        padding->iState = CEC_LOG_RECORD_PADDING;
+        iOffset = 0;
+      }
+
+      cec_log_record *record = At(iOffset);
+      record->iTime   = iTime;
+      record->iSize   = (uint16_t) iRecordSize;
+      record->iLength = (uint16_t) iLength;
+      record->iLevel  = (uint8_t) level;
+      record->iSource = iSource;
+      memcpy((char *)(record + 1), strMessage, iLength);
+      ((char *)(record + 1))[iLength] = 0;
+
+      AtomicBarrier();
+      record->iState = CEC_LOG_RECORD_COMMITTED;
+      return true;
+    }
+
+    /*!
+     * @brief Add the bytes of a frame as a CEC_LOG_TRAFFIC record. It's formatted when the consumer reads it.
+     */
+    bool Push(int64_t iTime, const cec_command &command, bool bOutgoing)
+    {
+      uint8_t frame[2 + sizeof(command.parameters.data)];
+      size_t iLength(0);
+
+      frame[iLength++] = ((uint8_t)command.initiator << 4) | (uint8_t)command.destination;
+      if (command.opcode_set)
+      {
+        frame[iLength++] = (uint8_t)command.opcode;
+        for (uint8_t iPtr = 0; iPtr < command.parameters.size; iPtr++)
+          frame[iLength++] = command.parameters[iPtr];
+      }
+
+      return Push(CEC_LOG_TRAFFIC, iTime, (const char *)frame, iLength, bOutgoing ? CEC_LOG_SOURCE_TRAFFIC_OUT : CEC_LOG_SOURCE_TRAFFIC_IN);
+    }
+    //@}
+
+    /*!
+     * @brief Append the name of the opcode to formatted traffic records, or only show the bytes when NULL.
+     */
+    void SetOpcodeNames(cec_log_opcode_name opcodeName) { m_opcodeName = opcodeName; }
+
+    /*!
+     * @name Consumer
+     * @brief Can be called by any thread.
+     */
+    //@{
+    /*!
+     * @brief Copy the oldest record to a message. When records were dropped, a warning with the number of dropped
+     *        records is passed first.
+     * @return True when a message was passed, false otherwise.
+     */
+    bool Pop(cec_log_message &message)
+    {
+      CLockObject lock(&m_readMutex);
+      return PopMessage(message);
+    }
+
+    /*!
+     * @brief Copy up to iMax records to messages while holding the lock once.
+     * @return The number of messages that were passed.
+     */
+    uint32_t Pop(cec_log_message *messages, uint32_t iMax)
+    {
+      uint32_t iCount(0);
+      CLockObject lock(&m_readMutex);
+      while (iCount < iMax && PopMessage(messages[iCount]))
+        iCount++;
+      return iCount;
+    }
+    //@}
+
+    bool     IsEmpty(void) const    { return m_iTail == m_iReserve; }
+    uint32_t Capacity(void) const   { return m_iSize; }
+    uint32_t Dropped(void) const    { return m_iDropped; }
+
+  private:
+    /*!
+     * @brief Peek() points to the oldest committed record in place, and it remains valid until Release() frees it.
+     *        Only called while holding m_readMutex.
+     */
+    bool Peek(const cec_log_record *&record)
+    {
+      while (m_iTail != m_iReserve)
+      {
+        cec_log_record *next = At(m_iTail & m_iMask);
+        if (next->iState == CEC_LOG_RECORD_FREE)
+          return false;
+        AtomicBarrier();
+
+        if (next->iState == CEC_LOG_RECORD_COMMITTED)
+        {
+          record = next;
+          return true;
+        }
+        Release();
+      }
+      return false;
+    }
+
+    void Release(void)
+    {
+      cec_log_record *record = At(m_iTail & m_iMask);
+      uint32_t iSize = record->iSize;
+      memset(record, 0, iSize);
+      AtomicBarrier();
+      m_iTail += iSize;
+    }
+
+    bool PopMessage(cec_log_message &message)
+    {
+      uint32_t iDropped = m_iDropped;
+      if (iDropped != m_iReportedDropped)
+      {
+        snprintf(message.message, sizeof(message.message), "log buffer full, %u messages dropped", iDropped - m_iReportedDropped);
+        message.level      = CEC_LOG_WARNING;
+        message.time       = m_iLastTime;
+        m_iReportedDropped = iDropped;
+        return true;
+      }
+
+      const cec_log_record *record;
+      if (!Peek(record))
+        return false;
+
+      if (record->iSource == CEC_LOG_SOURCE_TEXT)
+        memcpy(message.message, record->Message(), record->iLength + 1);
+      else
+        FormatTraffic(*record, message.message, sizeof(message.message));
+      message.level = (cec_log_level) record->iLevel;
+      message.time  = record->iTime;
+      m_iLastTime   = record->iTime;
+      Release();
+      return true;
+    }
+
+    /*!
+     * @brief Format a traffic record like "<< 1f:82:10:00", with "<<" for transmitted and ">>" for received frames.
+     */
+    void FormatTraffic(const cec_log_record &record, char *strMessage, size_t iSize) const
+    {
+      static const char strHex[] = "0123456789abcdef";
+      const uint8_t *frame = (const uint8_t *)record.Message();
+      char cDirection = record.iSource == CEC_LOG_SOURCE_TRAFFIC_OUT ? '<' : '>';
+      size_t iPtr(0);
+
+      strMessage[iPtr++] = cDirection;
+      strMessage[iPtr++] = cDirection;
+      for (uint16_t iByte = 0; iByte < record.iLength; iByte++)
+      {
+        strMessage[iPtr++] = iByte == 0 ? ' ' : ':';
+        strMessage[iPtr++] = strHex[frame[iByte] >> 4];
+        strMessage[iPtr++] = strHex[frame[iByte] & 0xF];
+      }
+      strMessage[iPtr] = 0;
+
+      cec_log_opcode_name opcodeName = m_opcodeName;
+      if (opcodeName && record.iLength > 1)
+        snprintf(strMessage + iPtr, iSize - iPtr, " (%s)", opcodeName((cec_opcode)frame[1]));
+    }
+
+    cec_log_record *At(uint32_t iOffset) const { return (cec_log_record *)((uint8_t *)m_buffer + iOffset); }
+
+    uint64_t *                   m_buffer;
+    uint32_t                     m_iSize;
+    uint32_t                     m_iMask;
+    volatile uint32_t            m_iReserve;
+    volatile uint32_t            m_iTail;
+    volatile uint32_t            m_iDropped;
+    uint32_t                     m_iReportedDropped;
+    int64_t                      m_iLastTime;
+    cec_log_opcode_name volatile m_opcodeName;
+    CMutex                       m_readMutex;
+  };
+};
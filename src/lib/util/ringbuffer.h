@@ -0,0 +1,156 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include "../platform/atomics.h"
+#include <stdint.h>
+
+namespace CEC
+{
+  #define CEC_CACHE_LINE_SIZE 64
+
+  /*!
+   * @brief Lock-free ring buffer for exactly one producer and one consumer thread.
+   *
+   * The capacity is rounded up to a power of two. The head is only written by
+   * the producer and the tail only by the consumer, and both are kept on their
+   * own cache line. Push() never blocks: when the buffer is full, the entry is
+   * rejected and the overflow counter is increased.
+   */
+  template<typename _BType>
+    class CecRingBuffer
+    {
+    public:
+      CecRingBuffer(unsigned int iMinSize = 128) :
+        m_iHead(0),
+        m_iOverflows(0),
+        m_iTail(0)
+      {
+        m_iSize = 1;
+        while (m_iSize < iMinSize)
+          m_iSize <<= 1;
+        m_iMask  = m_iSize - 1;
+        m_buffer = new _BType[m_iSize];
+      }
+
+      virtual ~CecRingBuffer(void)
+      {
+        delete[] m_buffer;
+      }
+
+      /** @name Producer */
+      //@{
+      bool Push(const _BType &entry)
+      {
+        return Push(&entry, 1) == 1;
+      }
+
+      unsigned int Push(const _BType *entries, unsigned int iCount)
+      {
+        unsigned int iHead = m_iHead;
+        unsigned int iFree = m_iSize - (iHead - m_iTail);
+        AtomicBarrier();
+
+        if (iCount > iFree)
+        {
+          m_iOverflows += iCount - iFree;
+          iCount = iFree;
+        }
+
+        for (unsigned int iPtr = 0; iPtr < iCount; iPtr++)
+          m_buffer[(iHead + iPtr) & m_iMask] = entries[iPtr];
+
+        AtomicBarrier();
+        m_iHead = iHead + iCount;
+        return iCount;
+      }
+      //@}
+
+      /** @name Consumer */
+      //@{
+      bool Pop(_BType &entry)
+      {
+        return Pop(&entry, 1) == 1;
+      }
+
+      unsigned int Pop(_BType *entries, unsigned int iMax)
+      {
+        unsigned int iTail  = m_iTail;
+        unsigned int iCount = m_iHead - iTail;
+        AtomicBarrier();
+
+        if (iCount > iMax)
+          iCount = iMax;
+
+        for (unsigned int iPtr = 0; iPtr < iCount; iPtr++)
+          entries[iPtr] = m_buffer[(iTail + iPtr) & m_iMask];
+
+        AtomicBarrier();
+        m_iTail = iTail + iCount;
+        return iCount;
+      }
+
+      bool Peek(_BType &entry) const
+      {
+        unsigned int iTail = m_iTail;
+        if (m_iHead == iTail)
+          return false;
+        AtomicBarrier();
+
+        entry = m_buffer[iTail & m_iMask];
+        return true;
+      }
+
+      void Clear(void)
+      {
+        AtomicBarrier();
+        m_iTail = m_iHead;
+      }
+      //@}
+
+      unsigned int Size(void) const     { return m_iHead - m_iTail; }
+      bool         IsEmpty(void) const  { return m_iHead == m_iTail; }
+      unsigned int Capacity(void) const { return m_iSize; }
+      uint64_t     Overflows(void) const { return m_iOverflows; }
+
+    private:
+      _BType *              m_buffer;
+      unsigned int          m_iSize;
+      unsigned int          m_iMask;
+      uint8_t               m_pad0[CEC_CACHE_LINE_SIZE];
+      volatile unsigned int m_iHead;
+      uint64_t              m_iOverflows;
+      uint8_t               m_pad1[CEC_CACHE_LINE_SIZE - sizeof(unsigned int) - sizeof(uint64_t)];
+      volatile unsigned int m_iTail;
+      uint8_t               m_pad2[CEC_CACHE_LINE_SIZE - sizeof(unsigned int)];
+    };
+};
@@ -0,0 +1,123 @@
+#pragma once
+/*
+ * This file is part of the libCEC(R) library.
+ *
+ * libCEC(R) is Copyright (C) 2011 Pulse-Eight Limited.  All rights reserved.
+ * libCEC(R) is an original work, containing original code.
+ *
+ * libCEC(R) is a trademark of Pulse-Eight Limited.
+ *
+ * This program is dual-licensed; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *
+ * Alternatively, you can license this library under a commercial license,
+ * please contact Pulse-Eight Licensing for more information.
+ *
+ * For more information contact:
+ * Pulse-Eight Licensing       <license@pulse-eight.com>
+ *     http://www.pulse-eight.com/
+ *     http://www.pulse-eight.net/
+ */
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+namespace CEC
+{
+  typedef struct cec_timer
+  {
+    int64_t      iDeadline;
+    unsigned int iTimer;
+
+    /* orders the heap by the earliest deadline */
+    bool operator <(const cec_timer &other) const { return iDeadline > other.iDeadline; }
+  } cec_timer;
+
+  /*!
+   * @brief Min-heap of deadlines for a fixed number of timers, so the owner can sleep until the first one expires.
+   *
+   * Every timer is identified by a number below the size that was passed to the constructor. Rescheduling or
+   * cancelling a timer doesn't search the heap: the current deadline of every timer is kept in a table, and heap
+   * entries that don't match it anymore are skipped. This class is not thread safe, it's meant to be used by the
+   * thread that runs the timers.
+   */
+  class CecTimerQueue
+  {
+  public:
+    CecTimerQueue(unsigned int iTimers) :
+      m_iScheduled(iTimers, 0) {}
+
+    /*!
+     * @brief Schedule a timer, replacing its previous deadline.
+     * @param iTimer The timer.
+     * @param iDeadline The time in ms, as returned by GetTimeMs(), at which it expires.
+     */
+    void Schedule(unsigned int iTimer, int64_t iDeadline)
+    {
+      cec_timer timer;
+      timer.iDeadline = iDeadline;
+      timer.iTimer    = iTimer;
+
+      m_iScheduled[iTimer] = iDeadline;
+      m_heap.push_back(timer);
+      std::push_heap(m_heap.begin(), m_heap.end());
+    }
+
+    void Cancel(unsigned int iTimer)            { m_iScheduled[iTimer] = 0; }
+    bool IsScheduled(unsigned int iTimer) const { return m_iScheduled[iTimer] != 0; }
+
+    /*!
+     * @return The deadline of the first timer that expires, or 0 when no timer is scheduled.
+     */
+    int64_t NextDeadline(void)
+    {
+      RemoveStale();
+      return m_heap.empty() ? 0 : m_heap.front().iDeadline;
+    }
+
+    /*!
+     * @brief Remove the first timer that expired.
+     * @param iNow The current time.
+     * @param iTimer The timer that expired.
+     * @return True when a timer expired, false otherwise.
+     */
+    bool PopExpired(int64_t iNow, unsigned int &iTimer)
+    {
+      RemoveStale();
+      if (m_heap.empty() || m_heap.front().iDeadline > iNow)
+        return false;
+
+      iTimer = m_heap.front().iTimer;
+      m_iScheduled[iTimer] = 0;
+      std::pop_heap(m_heap.begin(), m_heap.end());
+      m_heap.pop_back();
+      return true;
+    }
+
+  private:
+    void RemoveStale(void)
+    {
+      while (!m_heap.empty() && m_heap.front().iDeadline != m_iScheduled[m_heap.front().iTimer])
+      {
+        std::pop_heap(m_heap.begin(), m_heap.end());
+        m_heap.pop_back();
+      }
+    }
+
+    std::vector<cec_timer> m_heap;
+    std::vector<int64_t>   m_iScheduled;
+  };
+};
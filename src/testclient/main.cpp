@@ -44,13 +44,17 @@
 using namespace CEC;
 using namespace std;
 
-#define CEC_TEST_CLIENT_VERSION 1
+#define CEC_TEST_CLIENT_VERSION   2
+#define CEC_TEST_CLIENT_LIB_MAJOR 1
+#define CEC_TEST_CLIENT_LIB_MINOR 3
+#define CEC_TEST_CLIENT_BATCH_SIZE 16
 
 #include <cecloader.h>
 
 int        g_cecLogLevel = CEC_LOG_ALL;
 ofstream   g_logOutput;
 bool       g_bShortLog = false;
+bool       g_bLogCallback = false;
 CStdString g_strPort;
 
 inline bool HexStrToInt(const std::string& data, uint8_t& value)
@@ -105,50 +109,66 @@ bool GetWord(string& data, string& word)
   return true;
 }
 
-void FlushLog(ICECAdapter *cecParser)
+void PrintLogMessage(const cec_log_message &message)
 {
-  cec_log_message message;
-  while (cecParser && cecParser->GetNextLogMessage(&message))
+  if ((message.level & g_cecLogLevel) == message.level)
   {
-    if ((message.level & g_cecLogLevel) == message.level)
+    CStdString strLevel;
+    switch (message.level)
     {
-      CStdString strLevel;
-      switch (message.level)
-      {
-      case CEC_LOG_ERROR:
-        strLevel = "ERROR:   ";
-        break;
-      case CEC_LOG_WARNING:
-        strLevel = "WARNING: ";
-        break;
-      case CEC_LOG_NOTICE:
-        strLevel = "NOTICE:  ";
-        break;
-      case CEC_LOG_TRAFFIC:
-        strLevel = "TRAFFIC: ";
-        break;
-      case CEC_LOG_DEBUG:
-        strLevel = "DEBUG:   ";
-        break;
-      default:
-        break;
-      }
+    case CEC_LOG_ERROR:
+      strLevel = "ERROR:   ";
+      break;
+    case CEC_LOG_WARNING:
+      strLevel = "WARNING: ";
+      break;
+    case CEC_LOG_NOTICE:
+      strLevel = "NOTICE:  ";
+      break;
+    case CEC_LOG_TRAFFIC:
+      strLevel = "TRAFFIC: ";
+      break;
+    case CEC_LOG_DEBUG:
+      strLevel = "DEBUG:   ";
+      break;
+    default:
+      break;
+    }
 
-      CStdString strFullLog;
-      strFullLog.Format("%s[%16lld]\t%s", strLevel.c_str(), message.time, message.message);
-      cout << strFullLog.c_str() << endl;
+    CStdString strFullLog;
+    strFullLog.Format("%s[%16lld]\t%s", strLevel.c_str(), message.time, message.message);
+    cout << strFullLog.c_str() << endl;
 
-      if (g_logOutput.is_open())
-      {
-        if (g_bShortLog)
-          g_logOutput << message.message << endl;
-        else
-          g_logOutput << strFullLog.c_str() << endl;
-      }
+    if (g_logOutput.is_open())
+    {
+      if (g_bShortLog)
+        g_logOutput << message.message << endl;
+      else
+        g_logOutput << strFullLog.c_str() << endl;
     }
   }
 }
 
+void CecLogMessage(void * /* param */, const cec_log_message &message)
+{
+  PrintLogMessage(message);
+}
+
+void FlushLog(ICECAdapter *cecParser)
+{
+  /* messages are printed by the callback thread, and printing them from this thread as well would mix the output */
+  if (g_bLogCallback)
+    return;
+
+  cec_log_message messages[CEC_TEST_CLIENT_BATCH_SIZE];
+  uint32_t iCount;
+  while (cecParser && (iCount = cecParser->GetNextLogMessages(messages, CEC_TEST_CLIENT_BATCH_SIZE)) > 0)
+  {
+    for (uint32_t iPtr = 0; iPtr < iCount; iPtr++)
+      PrintLogMessage(messages[iPtr]);
+  }
+}
+
 void ListDevices(ICECAdapter *parser)
 {
   cec_adapter *devices = new cec_adapter[10];
@@ -171,6 +191,16 @@ void ListDevices(ICECAdapter *parser)
   }
 }
 
+/* the methods that were added in libcec 1.3 aren't in the vtable of older versions of the library */
+bool IsCompatible(ICECAdapter *parser)
+{
+  if (!parser || parser->GetMinLibVersion() > CEC_TEST_CLIENT_VERSION)
+    return false;
+
+  return parser->GetLibVersionMajor() > CEC_TEST_CLIENT_LIB_MAJOR ||
+      (parser->GetLibVersionMajor() == CEC_TEST_CLIENT_LIB_MAJOR && parser->GetLibVersionMinor() >= CEC_TEST_CLIENT_LIB_MINOR);
+}
+
 void ShowHelpCommandLine(const char* strExec)
 {
   cout << endl <<
@@ -181,6 +211,8 @@ void ShowHelpCommandLine(const char* strExec)
       "  -l --list-devices           List all devices on this system" << endl <<
       "  -t --type {p|r|t|a}         The device type to use. More than one is possible." << endl <<
       "  -p --port {int}             The HDMI port to use as active source." << endl <<
+      "  -c --cache-dir {dir}        Store the bus configuration in this directory and" << endl <<
+      "                              use it the next time the client is started." << endl <<
       "  -f --log-file {file}        Writes all libCEC log message to a file" << endl <<
       "  -sf --short-log-file {file} Writes all libCEC log message without timestamps" << endl <<
       "                              and log levels to a file." << endl <<
@@ -198,7 +230,7 @@ void ShowHelpCommandLine(const char* strExec)
 ICECAdapter *CreateParser(cec_device_type_list typeList)
 {
   ICECAdapter *parser = LibCecInit("CECTester", typeList);
-  if (!parser || parser->GetMinLibVersion() > CEC_TEST_CLIENT_VERSION)
+  if (!IsCompatible(parser))
   {
   #ifdef __WINDOWS__
     cout << "Cannot load libcec.dll" << endl;
@@ -235,6 +267,7 @@ void ShowHelpConsole(void)
   "[pow] {addr}              get the power status of the specified device." << endl <<
   "[poll] {addr}             poll the specified device." << endl <<
   "[lad]                     lists active devices on the bus" << endl <<
+  "[scan]                    polls all devices on the bus in one pass" << endl <<
   "[ad] {addr}               checks whether the specified device is active." << endl <<
   "[at] {type}               checks whether the specified device type is active." << endl <<
   "[volup]                   send a volume up command to the amp if present" << endl <<
@@ -255,6 +288,7 @@ void ShowHelpConsole(void)
 int main (int argc, char *argv[])
 {
   int8_t iHDMIPort(-1);
+  const char *strCacheDir(NULL);
   cec_device_type_list typeList;
   typeList.clear();
 
@@ -376,6 +410,17 @@ int main (int argc, char *argv[])
         }
         ++iArgPtr;
       }
+      else if (!strcmp(argv[iArgPtr], "-c") ||
+               !strcmp(argv[iArgPtr], "--cache-dir"))
+      {
+        if (argc >= iArgPtr + 2)
+        {
+          strCacheDir = argv[iArgPtr + 1];
+          cout << "using device cache directory '" << strCacheDir << "'" << endl;
+          ++iArgPtr;
+        }
+        ++iArgPtr;
+      }
       else
       {
         g_strPort = argv[iArgPtr++];
@@ -391,7 +436,7 @@ int main (int argc, char *argv[])
   }
 
   ICECAdapter *parser = LibCecInit("CECTester", typeList);
-  if (!parser || parser->GetMinLibVersion() > CEC_TEST_CLIENT_VERSION)
+  if (!IsCompatible(parser))
   {
 #ifdef __WINDOWS__
     cout << "Cannot load libcec.dll" << endl;
@@ -401,6 +446,15 @@ int main (int argc, char *argv[])
     return 1;
   }
 
+  /* print log messages as soon as they are added, instead of after the next command */
+  cec_callbacks callbacks;
+  callbacks.Clear();
+  callbacks.CBLogMessage = &CecLogMessage;
+  g_bLogCallback = parser->EnableCallbacks(&callbacks);
+
+  /* don't let the library format messages that aren't printed */
+  parser->SetLogLevel(g_cecLogLevel);
+
   if (!bSingleCommand)
   {
     CStdString strLog;
@@ -446,6 +500,9 @@ int main (int argc, char *argv[])
     FlushLog(parser);
   }
 
+  if (strCacheDir)
+    parser->EnableDeviceCache(strCacheDir);
+
   cout << "scanning the CEC bus..." << endl;
 
   if (!parser->Open(g_strPort.c_str()))
@@ -478,8 +535,8 @@ int main (int argc, char *argv[])
     FlushLog(parser);
 
     /* just ignore the command buffer and clear it */
-    cec_command dummy;
-    while (parser && parser->GetNextCommand(&dummy)) {}
+    cec_command dummy[CEC_TEST_CLIENT_BATCH_SIZE];
+    while (parser && parser->GetNextCommands(dummy, CEC_TEST_CLIENT_BATCH_SIZE) > 0) {}
 
     string input;
     getline(cin, input);
@@ -722,6 +779,19 @@ int main (int argc, char *argv[])
             if (addresses[iPtr])
               cout << "logical address " << iPtr << endl;
         }
+        else if (command == "scan")
+        {
+          cec_bus_scan_result result;
+          if (parser->ScanBus(&result))
+          {
+            cout << "bus scanned in " << result.iDurationMs << " ms:" << endl;
+            for (unsigned iPtr = 0; iPtr < 15; iPtr++)
+              if (result.present[iPtr])
+                cout << "logical address " << iPtr << endl;
+          }
+          else
+            cout << "could not scan the bus" << endl;
+        }
         else if (command == "ad")
         {
           CStdString strDev;
@@ -779,6 +849,7 @@ int main (int argc, char *argv[])
             if (iNewLevel >= CEC_LOG_ERROR && iNewLevel <= CEC_LOG_ALL)
             {
               g_cecLogLevel = iNewLevel;
+              parser->SetLogLevel(g_cecLogLevel);
               cout << "log level changed to " << strLevel.c_str() << endl;
             }
           }